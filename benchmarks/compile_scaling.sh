@@ -0,0 +1,35 @@
+# this should run from the root of the git repo
+# times compiling generated modules of increasing size. each function
+# declares locals, loops, and calls the one before it, so a module of
+# n functions is 7n + 1 lines long. compile time should double along
+# with the size of the module.
+GREYHAWK=${GREYHAWK:-./old/bin/greyhawk}
+SIZES=${SIZES:-"1000 2000 4000 8000"}
+MODULE=$(mktemp /tmp/compile_scaling.XXXXXX)
+
+generate() {
+    for ((i = 0; i < $1; i++)); do
+        printf 'g_%d := %d\n' $i $i
+        printf 'Int f_%d(n Int):\n' $i
+        printf '\ttotal := n + g_%d\n' $i
+        printf '\tfor i := 0; i < 3; i += 1:\n'
+        printf '\t\ttotal += i\n'
+        if [ $i -eq 0 ]; then
+            printf '\treturn total\n\n'
+        else
+            printf '\treturn total + f_%d(n)\n\n' $((i - 1))
+        fi
+    done
+    printf 'print(f_%d(1))\n' $(($1 - 1))
+}
+
+echo "benchmarking compile time..."
+for size in $SIZES; do
+    generate $size > $MODULE
+    echo
+    echo "$size functions, $(wc -l < $MODULE) lines:"
+    # --bytecode compiles the module without running it, and --no-cache
+    # makes sure it's compiled rather than loaded.
+    time $GREYHAWK --bytecode --no-cache $MODULE > /dev/null
+done
+rm $MODULE
@@ -0,0 +1,64 @@
+# this should run from the root of the git repo
+# times starting greyhawk up, on a script that does next to nothing.
+# every launch is timed from outside, and greyhawk reports how long it
+# took to get to its first instruction, which is averaged over the
+# launches. warm launches load the module from its bytecode cache,
+# cold ones compile it. prelude and snapshot launches both start from
+# what a prelude leaves behind: the first runs it in front of the
+# script every time (after the first instruction, so only the outside
+# time counts it), the second loads it from a snapshot.
+GREYHAWK=${GREYHAWK:-./old/bin/greyhawk}
+COUNT=${COUNT:-100}
+SCRIPT=$(mktemp -d /tmp/startup.XXXXXX)/startup.gh
+PRELUDE=$(dirname $SCRIPT)/prelude.gh
+SNAPSHOT=$(dirname $SCRIPT)/prelude.ghs
+cp ./benchmarks/helloworld/helloworld.gh $SCRIPT
+cat > $PRELUDE <<PRELUDE
+class Point:
+	x Int
+	y Int
+	Int sum():
+		return x + y
+
+squares := [0, 0, 0, 0, 0, 0, 0, 0]
+for i := 0; i < 8; i += 1:
+	squares[i] = i * i
+points := [Point(0, 0), Point(1, 1)]
+total := 0
+for i := 0; i < 10000; i += 1:
+	total += squares[7] + i
+PRELUDE
+
+launch() {
+    for ((run = 0; run < $COUNT; run++)); do
+        $GREYHAWK --startup-stats "$@" $SCRIPT 2>&1 > /dev/null |
+            awk '/to the first instruction/ { sub("us", "", $2); print $2 }'
+    done
+}
+
+average() {
+    awk '{ total += $1 } END { printf "%dus\n", total / NR }'
+}
+
+echo "benchmarking startup, $COUNT launches..."
+for mode in cold warm prelude snapshot; do
+    if [ $mode == cold ]; then
+        options=--no-cache
+    elif [ $mode == warm ]; then
+        $GREYHAWK --compile-only $SCRIPT
+        options=
+    elif [ $mode == prelude ]; then
+        cat $PRELUDE ./benchmarks/helloworld/helloworld.gh > $SCRIPT
+        $GREYHAWK --compile-only $SCRIPT
+        options=
+    else
+        cp ./benchmarks/helloworld/helloworld.gh $SCRIPT
+        $GREYHAWK --write-snapshot $SNAPSHOT $PRELUDE > /dev/null
+        options="--snapshot $SNAPSHOT"
+    fi
+    echo
+    echo "$mode:"
+    time launch $options > ${SCRIPT}.times
+    echo "time to first instruction: $(average < ${SCRIPT}.times)"
+done
+rm -r $(dirname $SCRIPT)
@@ -0,0 +1,153 @@
+#include "passes.hpp"
+#include <string.h>
+
+using namespace VM;
+
+namespace codegen {
+
+  int getOperandCount(GInstruction& instruction) {
+    return getInstructionSize(instruction.op, instruction.args) - 1;
+  }
+
+  bool isJumpOperand(GOPCODE op, int operand) {
+    auto kinds = getOpInfo(op).operands;
+    return operand < (int) strlen(kinds) && kinds[operand] == 'j';
+  }
+
+  std::vector<int> getRegistersRead(GInstruction& instruction) {
+    std::vector<int> registers;
+    auto kinds = getOpInfo(instruction.op).operands;
+    for (int i = 0; kinds[i] != '\0'; i++) {
+      switch (kinds[i]) {
+      case 'r':
+      case 'x':
+        registers.push_back(instruction.args[i].registerNum);
+        break;
+      case 'n':
+        for (int j = 0; j < instruction.args[i].size; j++) {
+          registers.push_back(instruction.args[i + 1 + j].registerNum);
+        }
+        break;
+      }
+    }
+    return registers;
+  }
+
+  std::vector<int> getRegistersWritten(GInstruction& instruction) {
+    std::vector<int> registers;
+    auto kinds = getOpInfo(instruction.op).operands;
+    for (int i = 0; kinds[i] != '\0'; i++) {
+      if (kinds[i] == 'w' || kinds[i] == 'x') {
+        registers.push_back(instruction.args[i].registerNum);
+      }
+    }
+    return registers;
+  }
+
+  std::map<int, int> countRegisterReads(GInstructions& instructions) {
+    std::map<int, int> reads;
+    for (auto& instruction : instructions) {
+      for (auto registerNum : getRegistersRead(instruction)) {
+        reads[registerNum]++;
+      }
+    }
+    return reads;
+  }
+
+  std::map<int, int> countRegisterWrites(GInstructions& instructions) {
+    std::map<int, int> writes;
+    for (auto& instruction : instructions) {
+      for (auto registerNum : getRegistersWritten(instruction)) {
+        writes[registerNum]++;
+      }
+    }
+    return writes;
+  }
+
+  bool isTemporary(GEnvironment* environment, int registerNum) {
+    return registerNum < (int) environment->localsTemporary.size() &&
+      environment->localsTemporary[registerNum];
+  }
+
+  void toAbsoluteJumps(GInstructions& instructions) {
+    for (int i = 0; i < (int) instructions.size(); i++) {
+      auto& instruction = instructions[i];
+      for (int j = 0; j < getOperandCount(instruction); j++) {
+        if (isJumpOperand(instruction.op, j)) {
+          instruction.args[j].positionDiff += i;
+        }
+      }
+    }
+  }
+
+  void toRelativeJumps(GInstructions& instructions) {
+    for (int i = 0; i < (int) instructions.size(); i++) {
+      auto& instruction = instructions[i];
+      for (int j = 0; j < getOperandCount(instruction); j++) {
+        if (isJumpOperand(instruction.op, j)) {
+          instruction.args[j].positionDiff -= i;
+        }
+      }
+    }
+  }
+
+  std::vector<bool> findJumpTargets(GInstructions& instructions) {
+    std::vector<bool> targets(instructions.size() + 1, false);
+    for (auto& instruction : instructions) {
+      for (int j = 0; j < getOperandCount(instruction); j++) {
+        if (isJumpOperand(instruction.op, j)) {
+          targets[instruction.args[j].positionDiff] = true;
+        }
+      }
+    }
+    return targets;
+  }
+
+  void removeInstructions(GInstructions& instructions,
+                          std::vector<bool>& removed) {
+    int count = instructions.size();
+    // where every instruction ends up. removed instructions map to
+    // the instruction that follows them.
+    std::vector<int> newIndices(count + 1);
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+      newIndices[i] = kept;
+      if (!removed[i]) { kept++; }
+    }
+    newIndices[count] = kept;
+
+    GInstructions result;
+    result.reserve(kept);
+    for (int i = 0; i < count; i++) {
+      if (removed[i]) { continue; }
+      auto& instruction = instructions[i];
+      for (int j = 0; j < getOperandCount(instruction); j++) {
+        if (isJumpOperand(instruction.op, j)) {
+          instruction.args[j].positionDiff = newIndices[instruction.args[j].positionDiff];
+        }
+      }
+      result.push_back(instruction);
+    }
+    instructions.swap(result);
+  }
+
+  static int optimizationLevel = 0;
+
+  void setOptimizationLevel(int level) {
+    optimizationLevel = level;
+  }
+
+  GBytecode* finalizeInstructions(GEnvironment* environment,
+                                  GInstructions& instructions) {
+    if (optimizationLevel >= 1) {
+      foldConstants(instructions);
+      propagateCopies(environment, instructions);
+      eliminateDeadStores(environment, instructions);
+      threadJumps(instructions);
+    }
+    fuseInstructions(environment, instructions);
+    allocateRegisters(environment, instructions);
+    return assembleBytecode(&instructions[0], instructions.size(),
+                            environment->constants);
+  }
+}
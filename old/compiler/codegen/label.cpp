@@ -0,0 +1,23 @@
+#include "label.hpp"
+
+using namespace VM;
+
+namespace codegen {
+
+  void GLabel::addJump(std::vector<GInstruction>& instructions, int operand) {
+    int instruction = instructions.size() - 1;
+    if (position >= 0) {
+      instructions[instruction].args[operand].positionDiff = position - instruction;
+    } else {
+      jumps.push_back(std::make_pair(instruction, operand));
+    }
+  }
+
+  void GLabel::bind(std::vector<GInstruction>& instructions) {
+    position = instructions.size();
+    for (auto& jump : jumps) {
+      instructions[jump.first].args[jump.second].positionDiff = position - jump.first;
+    }
+    jumps.clear();
+  }
+}
@@ -0,0 +1,32 @@
+#include <utility>
+#include <vector>
+#include "../vm/vm.hpp"
+
+#ifndef CODEGEN_LABEL_HPP
+#define CODEGEN_LABEL_HPP
+
+namespace codegen {
+
+  /*
+    a place in the instructions of a body that can be jumped to. jumps
+    are emitted straight into the one buffer the body is generated
+    in, whether or not the label has a place yet: forward jumps are
+    patched when it's bound.
+   */
+  class GLabel {
+  public:
+    GLabel() : position(-1) {}
+
+    // the last instruction emitted jumps to the label with operand.
+    void addJump(std::vector<VM::GInstruction>& instructions, int operand);
+    // the label is at the next instruction to be emitted.
+    void bind(std::vector<VM::GInstruction>& instructions);
+
+  private:
+    int position;
+    // the instruction and operand of every jump waiting for a position.
+    std::vector<std::pair<int, int>> jumps;
+  };
+}
+
+#endif
@@ -0,0 +1,307 @@
+#include "passes.hpp"
+#include <map>
+#include <set>
+#include <string.h>
+
+using namespace VM;
+
+/*
+  the passes run with -O. they work on the instructions of a single
+  body, and only look at one basic block at a time, except for dead
+  store elimination (which counts reads over the whole body) and jump
+  threading.
+
+  registers that belong to variables can be read outside of the body
+  (by closures, or as globals), so only temporaries are ever removed
+  or renamed.
+ */
+namespace codegen {
+
+  // instructions that may run code which changes registers other
+  // than the ones they write.
+  static bool hasSideEffects(GOPCODE op) {
+    switch (op) {
+    case BUILTIN_CALL:
+    case CALL_DIRECT:
+    case CALL_METHOD_DIRECT:
+    case FUNCTION_CALL:
+    case GLOBAL_SET:
+    case INSTANCE_CREATE:
+    case LOAD_MODULE:
+    case PRIMITIVE_METHOD_CALL:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  // instructions that do nothing but write their result.
+  static bool isPure(GOPCODE op) {
+    switch (op) {
+    case ADD_INT:
+    case ARRAY_LOAD_LENGTH:
+    case CHAR_EQ:
+    case FLOAT_EQ:
+    case GLOBAL_LOAD:
+    case INT_EQ:
+    case INT_OR:
+    case LESS_THAN_INT:
+    case LOAD_CONSTANT_BOOL:
+    case LOAD_CONSTANT_CHAR:
+    case LOAD_CONSTANT_FLOAT:
+    case LOAD_CONSTANT_INT:
+    case LOAD_CONSTANT_STRING:
+    case MULTIPLY_INT:
+    case SET:
+    case STRING_COPY:
+    case STRING_LOAD_LENGTH:
+    case SUBTRACT_INT:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  // integer arithmetic wraps, like it does in the engine.
+  static int32_t foldInt(GOPCODE op, int32_t left, int32_t right) {
+    switch (op) {
+    case ADD_INT: return (int32_t) ((uint32_t) left + (uint32_t) right);
+    case SUBTRACT_INT: return (int32_t) ((uint32_t) left - (uint32_t) right);
+    case MULTIPLY_INT: return (int32_t) ((uint32_t) left * (uint32_t) right);
+    default: return (int32_t) ((uint32_t) left | (uint32_t) right);
+    }
+  }
+
+  /*
+    evaluates integer arithmetic and comparisons whose operands were
+    loaded as constants earlier in the same block, and turns branches
+    on a known condition into GO.
+   */
+  void foldConstants(GInstructions& instructions) {
+    toAbsoluteJumps(instructions);
+    auto targets = findJumpTargets(instructions);
+    std::map<int, int32_t> knownInts;
+    std::map<int, bool> knownBools;
+
+    for (int i = 0; i < (int) instructions.size(); i++) {
+      auto& instruction = instructions[i];
+      if (targets[i]) {
+        knownInts.clear();
+        knownBools.clear();
+      }
+
+      switch (instruction.op) {
+
+      case ADD_INT:
+      case INT_OR:
+      case MULTIPLY_INT:
+      case SUBTRACT_INT: {
+        auto left = knownInts.find(instruction.args[0].registerNum);
+        auto right = knownInts.find(instruction.args[1].registerNum);
+        if (left != knownInts.end() && right != knownInts.end()) {
+          auto result = foldInt(instruction.op, left->second, right->second);
+          instruction = GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] {
+              instruction.args[2].registerNum,
+          }};
+          instruction.args[1].asInt32 = result;
+        }
+        break;
+      }
+
+      case INT_EQ:
+      case LESS_THAN_INT: {
+        auto left = knownInts.find(instruction.args[0].registerNum);
+        auto right = knownInts.find(instruction.args[1].registerNum);
+        if (left != knownInts.end() && right != knownInts.end()) {
+          bool result = instruction.op == INT_EQ ?
+            left->second == right->second : left->second < right->second;
+          instruction = GInstruction { LOAD_CONSTANT_BOOL, new GOPARG[2] {
+              instruction.args[2].registerNum,
+          }};
+          instruction.args[1].asBool = result;
+        }
+        break;
+      }
+
+      case BRANCH: {
+        auto condition = knownBools.find(instruction.args[0].registerNum);
+        if (condition != knownBools.end()) {
+          auto target = instruction.args[condition->second ? 1 : 2];
+          instruction = GInstruction { GO, new GOPARG[1] { target } };
+        }
+        break;
+      }
+
+      default:
+        break;
+      }
+
+      if (hasSideEffects(instruction.op)) {
+        knownInts.clear();
+        knownBools.clear();
+      }
+      for (auto registerNum : getRegistersWritten(instruction)) {
+        knownInts.erase(registerNum);
+        knownBools.erase(registerNum);
+      }
+      if (instruction.op == LOAD_CONSTANT_INT) {
+        knownInts[instruction.args[0].registerNum] = instruction.args[1].asInt32;
+      } else if (instruction.op == LOAD_CONSTANT_BOOL) {
+        knownBools[instruction.args[0].registerNum] = instruction.args[1].asBool;
+      }
+    }
+
+    toRelativeJumps(instructions);
+  }
+
+  /*
+    removes the copies codegen leaves behind:
+
+    * a temporary written once and immediately copied into another
+      register (OP -> t; SET t -> x) is written to directly instead.
+    * reads of a temporary that holds a copy of another register
+      (SET a -> t) read that register instead, for as long as neither
+      changes within the block. the copy is then usually dead.
+   */
+  void propagateCopies(GEnvironment* environment, GInstructions& instructions) {
+    toAbsoluteJumps(instructions);
+    auto targets = findJumpTargets(instructions);
+    auto reads = countRegisterReads(instructions);
+    auto writes = countRegisterWrites(instructions);
+    std::vector<bool> removed(instructions.size(), false);
+
+    for (int i = 0; i + 1 < (int) instructions.size(); i++) {
+      auto& first = instructions[i];
+      auto& second = instructions[i + 1];
+      if (targets[i + 1] || second.op != SET || !isPure(first.op)) {
+        continue;
+      }
+      auto temporary = second.args[0].registerNum;
+      auto written = getRegistersWritten(first);
+      if (written.size() != 1 || written[0] != temporary ||
+          !isTemporary(environment, temporary) ||
+          reads[temporary] != 1 || writes[temporary] != 1) {
+        continue;
+      }
+      auto kinds = getOpInfo(first.op).operands;
+      first.args[strchr(kinds, 'w') - kinds].registerNum = second.args[1].registerNum;
+      removed[i + 1] = true;
+      i++;
+    }
+    removeInstructions(instructions, removed);
+
+    targets = findJumpTargets(instructions);
+    // temporary -> the register it's a copy of.
+    std::map<int, int> copies;
+    for (int i = 0; i < (int) instructions.size(); i++) {
+      auto& instruction = instructions[i];
+      if (targets[i]) {
+        copies.clear();
+      }
+
+      auto kinds = getOpInfo(instruction.op).operands;
+      for (int j = 0; kinds[j] != '\0'; j++) {
+        if (kinds[j] == 'r') {
+          auto copy = copies.find(instruction.args[j].registerNum);
+          if (copy != copies.end()) {
+            instruction.args[j].registerNum = copy->second;
+          }
+        } else if (kinds[j] == 'n') {
+          for (int k = 0; k < instruction.args[j].size; k++) {
+            auto& operand = instruction.args[j + 1 + k];
+            auto copy = copies.find(operand.registerNum);
+            if (copy != copies.end()) {
+              operand.registerNum = copy->second;
+            }
+          }
+        }
+      }
+
+      if (hasSideEffects(instruction.op)) {
+        copies.clear();
+      }
+      for (auto registerNum : getRegistersWritten(instruction)) {
+        copies.erase(registerNum);
+        for (auto copy = copies.begin(); copy != copies.end();) {
+          if (copy->second == registerNum) {
+            copies.erase(copy++);
+          } else {
+            ++copy;
+          }
+        }
+      }
+      if (instruction.op == SET &&
+          isTemporary(environment, instruction.args[1].registerNum) &&
+          instruction.args[0].registerNum != instruction.args[1].registerNum) {
+        copies[instruction.args[1].registerNum] = instruction.args[0].registerNum;
+      }
+    }
+
+    toRelativeJumps(instructions);
+  }
+
+  /*
+    removes pure instructions that only write temporaries nothing
+    reads, until there are none left.
+   */
+  void eliminateDeadStores(GEnvironment* environment, GInstructions& instructions) {
+    toAbsoluteJumps(instructions);
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      auto reads = countRegisterReads(instructions);
+      std::vector<bool> removed(instructions.size(), false);
+      for (int i = 0; i < (int) instructions.size(); i++) {
+        auto& instruction = instructions[i];
+        if (!isPure(instruction.op)) {
+          continue;
+        }
+        bool dead = true;
+        for (auto registerNum : getRegistersWritten(instruction)) {
+          if (!isTemporary(environment, registerNum) || reads[registerNum] > 0) {
+            dead = false;
+          }
+        }
+        if (dead) {
+          removed[i] = true;
+          changed = true;
+        }
+      }
+      removeInstructions(instructions, removed);
+    }
+    toRelativeJumps(instructions);
+  }
+
+  /*
+    jumps to a GO jump to where it goes instead, and a GO to the
+    instruction right after it is removed.
+   */
+  void threadJumps(GInstructions& instructions) {
+    toAbsoluteJumps(instructions);
+    int count = instructions.size();
+    for (auto& instruction : instructions) {
+      for (int j = 0; j < getOperandCount(instruction); j++) {
+        if (!isJumpOperand(instruction.op, j)) {
+          continue;
+        }
+        auto target = instruction.args[j].positionDiff;
+        // a loop made only of GOs never ends, so leave it be.
+        std::set<int> seen;
+        while (target < count && instructions[target].op == GO &&
+               seen.insert(target).second) {
+          target = instructions[target].args[0].positionDiff;
+        }
+        instruction.args[j].positionDiff = target;
+      }
+    }
+
+    std::vector<bool> removed(count, false);
+    for (int i = 0; i < count; i++) {
+      if (instructions[i].op == GO && instructions[i].args[0].positionDiff == i + 1) {
+        removed[i] = true;
+      }
+    }
+    removeInstructions(instructions, removed);
+    toRelativeJumps(instructions);
+  }
+}
@@ -0,0 +1,62 @@
+#include <map>
+#include <vector>
+#include "../vm/vm.hpp"
+
+#ifndef CODEGEN_PASSES_HPP
+#define CODEGEN_PASSES_HPP
+
+/*
+  passes over the instructions of a single body, run once it has been
+  generated and before it's assembled into bytecode.
+
+  jumps in GInstructions are relative to the jumping instruction,
+  which is inconvenient for passes that add or remove instructions.
+  those switch to absolute targets (the index of the instruction
+  jumped to) while they work, with the helpers below.
+ */
+namespace codegen {
+
+  typedef std::vector<VM::GInstruction> GInstructions;
+
+  // helpers
+  void toAbsoluteJumps(GInstructions&);
+  void toRelativeJumps(GInstructions&);
+  // with absolute jumps: which instructions are jumped to.
+  std::vector<bool> findJumpTargets(GInstructions&);
+  // with absolute jumps: drop every instruction marked as removed,
+  // retargeting jumps to them to the next instruction kept.
+  void removeInstructions(GInstructions&, std::vector<bool>& removed);
+
+  int  getOperandCount(VM::GInstruction&);
+  bool isJumpOperand(VM::GOPCODE, int operand);
+  std::vector<int> getRegistersRead(VM::GInstruction&);
+  std::vector<int> getRegistersWritten(VM::GInstruction&);
+  std::map<int, int> countRegisterReads(GInstructions&);
+  std::map<int, int> countRegisterWrites(GInstructions&);
+  // whether a register only holds an intermediate value of the body,
+  // rather than a variable that other bodies may read as a global.
+  bool isTemporary(VM::GEnvironment*, int registerNum);
+
+  // passes
+  void foldConstants(GInstructions&);
+  void propagateCopies(VM::GEnvironment*, GInstructions&);
+  void eliminateDeadStores(VM::GEnvironment*, GInstructions&);
+  void threadJumps(GInstructions&);
+  void fuseInstructions(VM::GEnvironment*, GInstructions&);
+  // renumbers temporaries, shrinking the locals of the environment.
+  void allocateRegisters(VM::GEnvironment*, GInstructions&);
+
+  /*
+    the optimization level:
+
+    * 0: only superinstructions are formed, and registers allocated.
+    * 1: constant folding, copy propagation, dead store elimination and
+         jump threading run first.
+   */
+  void setOptimizationLevel(int level);
+
+  // runs every pass, and assembles the result.
+  VM::GBytecode* finalizeInstructions(VM::GEnvironment*, GInstructions&);
+}
+
+#endif
@@ -0,0 +1,95 @@
+#include "passes.hpp"
+#include <map>
+
+using namespace VM;
+
+namespace codegen {
+
+  /*
+    replaces common pairs of instructions with a single superinstruction:
+
+    * INT_EQ / LESS_THAN_INT into a register only read by the BRANCH
+      that follows becomes BRANCH_IF_EQ_INT / BRANCH_IF_LT_INT.
+    * LOAD_CONSTANT_INT followed by an ADD_INT of that constant becomes
+      ADD_INT_IMM (or INC_INT, when adding one to a register in place)
+      if nothing else reads the constant, and LOAD_CONST_ADD otherwise.
+
+    a register is only fused away if it's a temporary: the register of
+    a variable can still be read by nested functions, as a global.
+   */
+  void fuseInstructions(GEnvironment* environment, GInstructions& instructions) {
+    toAbsoluteJumps(instructions);
+    auto targets = findJumpTargets(instructions);
+    auto reads = countRegisterReads(instructions);
+    std::vector<bool> removed(instructions.size(), false);
+
+    for (int i = 0; i + 1 < (int) instructions.size(); i++) {
+      auto& first = instructions[i];
+      auto& second = instructions[i + 1];
+      // the second instruction goes away, so nothing can jump to it.
+      if (targets[i + 1]) {
+        continue;
+      }
+
+      switch (first.op) {
+
+      case INT_EQ:
+      case LESS_THAN_INT: {
+        auto result = first.args[2].registerNum;
+        if (second.op != BRANCH || second.args[0].registerNum != result ||
+            reads[result] != 1 || !isTemporary(environment, result)) {
+          break;
+        }
+        first = GInstruction {
+          first.op == INT_EQ ? BRANCH_IF_EQ_INT : BRANCH_IF_LT_INT,
+          new GOPARG[4] { first.args[0], first.args[1], second.args[1], second.args[2] }
+        };
+        removed[i + 1] = true;
+        i++;
+        break;
+      }
+
+      case LOAD_CONSTANT_INT: {
+        if (second.op != ADD_INT) {
+          break;
+        }
+        auto constant = first.args[0].registerNum;
+        auto value = first.args[1].asInt32;
+        auto result = second.args[2].registerNum;
+        int other;
+        if (second.args[0].registerNum == constant) {
+          other = second.args[1].registerNum;
+        } else if (second.args[1].registerNum == constant) {
+          other = second.args[0].registerNum;
+        } else {
+          break;
+        }
+        if (other == constant) {
+          break;
+        }
+
+        if (reads[constant] != 1 || !isTemporary(environment, constant)) {
+          first = GInstruction { LOAD_CONST_ADD, new GOPARG[4] {
+              constant, value, other, result
+          }};
+        } else if (other == result && value == 1) {
+          first = GInstruction { INC_INT, new GOPARG[1] { result } };
+        } else {
+          first = GInstruction { ADD_INT_IMM, new GOPARG[3] {
+              other, value, result
+          }};
+        }
+        removed[i + 1] = true;
+        i++;
+        break;
+      }
+
+      default:
+        break;
+      }
+    }
+
+    removeInstructions(instructions, removed);
+    toRelativeJumps(instructions);
+  }
+}
@@ -0,0 +1,223 @@
+#include "passes.hpp"
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+#include <stdint.h>
+
+using namespace VM;
+
+/*
+  codegen hands out a new register for every temporary, so the frame
+  of a body grows with its size. this renumbers the temporaries of a
+  body so that ones that are never live at the same time share a
+  register, with a linear scan over their live ranges.
+
+  variables keep their registers: closures, globals and attributes
+  refer to them by index. temporaries only share a register with
+  temporaries of the same type, so the garbage collector can trust the
+  type of a register.
+ */
+namespace codegen {
+
+  // with absolute jumps: the instructions that may run after
+  // instruction i.
+  static std::vector<int> getSuccessors(GInstructions& instructions, int i) {
+    std::vector<int> successors;
+    auto& instruction = instructions[i];
+    switch (instruction.op) {
+    case END:
+    case RETURN:
+    case RETURN_NONE:
+      break;
+    case GO:
+      successors.push_back(instruction.args[0].positionDiff);
+      break;
+    default:
+      bool jumps = false;
+      for (int j = 0; j < getOperandCount(instruction); j++) {
+        if (isJumpOperand(instruction.op, j)) {
+          successors.push_back(instruction.args[j].positionDiff);
+          jumps = true;
+        }
+      }
+      // branches always take one of their targets.
+      if (!jumps) {
+        successors.push_back(i + 1);
+      }
+      break;
+    }
+    return successors;
+  }
+
+  // every operand that names a register, read or written.
+  static std::vector<GOPARG*> getRegisterOperands(GInstruction& instruction) {
+    std::vector<GOPARG*> operands;
+    auto kinds = getOpInfo(instruction.op).operands;
+    for (int i = 0; kinds[i] != '\0'; i++) {
+      switch (kinds[i]) {
+      case 'w':
+      case 'r':
+      case 'x':
+        operands.push_back(&instruction.args[i]);
+        break;
+      case 'n':
+        for (int j = 0; j < instruction.args[i].size; j++) {
+          operands.push_back(&instruction.args[i + 1 + j]);
+        }
+        break;
+      }
+    }
+    return operands;
+  }
+
+  typedef struct {
+    int registerNum;
+    int start;
+    int end;
+  } GLiveRange;
+
+  void allocateRegisters(GEnvironment* environment, GInstructions& instructions) {
+    toAbsoluteJumps(instructions);
+    int count = instructions.size();
+    int localsCount = environment->localsCount;
+    auto& temporary = environment->localsTemporary;
+
+    // liveness of the temporaries before every instruction, solved
+    // backwards until nothing changes.
+    std::vector<std::vector<int>> reads(count), writes(count), successors(count);
+    for (int i = 0; i < count; i++) {
+      for (auto registerNum : getRegistersRead(instructions[i])) {
+        if (temporary[registerNum]) { reads[i].push_back(registerNum); }
+      }
+      for (auto registerNum : getRegistersWritten(instructions[i])) {
+        if (temporary[registerNum]) { writes[i].push_back(registerNum); }
+      }
+      for (auto successor : getSuccessors(instructions, i)) {
+        if (successor < count) { successors[i].push_back(successor); }
+      }
+    }
+
+    // one bit per register, 64 to a word.
+    int words = (localsCount + 63) / 64;
+    std::vector<std::vector<uint64_t>> liveIn(count, std::vector<uint64_t>(words, 0));
+    std::vector<uint64_t> live(words);
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (int i = count - 1; i >= 0; i--) {
+        std::fill(live.begin(), live.end(), 0);
+        for (auto successor : successors[i]) {
+          for (int w = 0; w < words; w++) { live[w] |= liveIn[successor][w]; }
+        }
+        for (auto r : writes[i]) { live[r / 64] &= ~(1ULL << (r % 64)); }
+        for (auto r : reads[i]) { live[r / 64] |= 1ULL << (r % 64); }
+        if (live != liveIn[i]) {
+          liveIn[i].swap(live);
+          changed = true;
+        }
+      }
+    }
+
+    // the range of every temporary covers every instruction it's live
+    // before, read or written by. anything jumping back into a range
+    // lands inside of it, so loops are covered as well.
+    std::vector<GLiveRange> ranges;
+    std::vector<int> rangeIndices(localsCount, -1);
+    auto extend = [&](int registerNum, int i) {
+      if (rangeIndices[registerNum] == -1) {
+        rangeIndices[registerNum] = ranges.size();
+        ranges.push_back(GLiveRange { registerNum, i, i });
+      }
+      auto& range = ranges[rangeIndices[registerNum]];
+      range.start = std::min(range.start, i);
+      range.end = std::max(range.end, i);
+    };
+    for (int i = 0; i < count; i++) {
+      for (int w = 0; w < words; w++) {
+        for (auto bits = liveIn[i][w]; bits != 0; bits &= bits - 1) {
+          extend(w * 64 + __builtin_ctzll(bits), i);
+        }
+      }
+      for (auto registerNum : reads[i]) { extend(registerNum, i); }
+      for (auto registerNum : writes[i]) { extend(registerNum, i); }
+    }
+    std::sort(ranges.begin(), ranges.end(), [](const GLiveRange& a, const GLiveRange& b) {
+        return a.start < b.start;
+    });
+
+    // registers temporaries can use: anything that isn't a variable.
+    std::set<int> unusedRegisters;
+    int highestVariable = -1;
+    for (int r = 0; r < localsCount; r++) {
+      if (temporary[r]) {
+        unusedRegisters.insert(r);
+      } else {
+        highestVariable = r;
+      }
+    }
+
+    // registers handed out, then released, the earliest first. reusing
+    // the register released longest ago instead of the last one keeps
+    // neighbouring instructions off the same slot, so they don't wait
+    // on each other's loads and stores.
+    std::map<GType*, std::deque<int>> releasedRegisters;
+    // the ranges still running, and the register they were given.
+    std::vector<std::pair<int, int>> active;
+    auto& types = environment->localsTypes;
+    // the type of the temporaries each register was handed out to.
+    std::vector<GType*> registerTypes(localsCount, NULL);
+    std::vector<int> assigned(localsCount, -1);
+    int highestRegister = highestVariable;
+    for (auto& range : ranges) {
+      for (auto it = active.begin(); it != active.end();) {
+        // an instruction may write its result before it's done
+        // reading its operands, so ranges ending where this one starts
+        // still count as running.
+        if (it->first < range.start) {
+          releasedRegisters[registerTypes[it->second]].push_back(it->second);
+          it = active.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      int registerNum;
+      auto& released = releasedRegisters[types[range.registerNum]];
+      if (!released.empty()) {
+        registerNum = released.front();
+        released.pop_front();
+      } else {
+        registerNum = *unusedRegisters.begin();
+        unusedRegisters.erase(unusedRegisters.begin());
+      }
+      assigned[range.registerNum] = registerNum;
+      registerTypes[registerNum] = types[range.registerNum];
+      active.push_back(std::make_pair(range.end, registerNum));
+      highestRegister = std::max(highestRegister, registerNum);
+    }
+
+    for (auto& instruction : instructions) {
+      for (auto operand : getRegisterOperands(instruction)) {
+        auto registerNum = operand->registerNum;
+        if (temporary[registerNum] && assigned[registerNum] != -1) {
+          operand->registerNum = assigned[registerNum];
+        }
+      }
+    }
+
+    // temporaries only live while a body runs, so every register
+    // past the last one used can go.
+    std::vector<GType*> localsTypes(environment->localsTypes.begin(),
+                                    environment->localsTypes.begin() + highestRegister + 1);
+    for (int r = 0; r < localsCount; r++) {
+      if (assigned[r] != -1) {
+        localsTypes[assigned[r]] = environment->localsTypes[r];
+      }
+    }
+    environment->localsTypes.swap(localsTypes);
+    environment->localsTemporary.resize(highestRegister + 1);
+    environment->localsCount = highestRegister + 1;
+
+    toRelativeJumps(instructions);
+  }
+}
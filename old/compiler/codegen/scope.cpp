@@ -14,11 +14,11 @@ namespace codegen {
   // a lot of methods are repeated from GEnvironment.
   // they should all probably be in addObject, but
   // I want to wait to see if they actually belong here.
-  GIndex* GScope::addObject(std::string name, VM::GType* type) {
+  GIndex* GScope::addObject(gstd::Symbol name, VM::GType* type) {
     if (parentScope == NULL) {
       return environment->addObject(name, type);
     } else {
-      auto val = environment->allocateObject(type);
+      auto val = environment->allocateVariable(type);
       localsByName[name] = val;
       return val;
     }
@@ -28,17 +28,27 @@ namespace codegen {
     return environment->allocateObject(type);
   }
 
-  GIndex* GScope::getObject(std::string name) {
-    if (localsByName.find(name) != localsByName.end()) {
-      return localsByName[name];
+  GIndex* GScope::getObject(gstd::Symbol name) {
+    if (auto local = localsByName.find(name)) {
+      return *local;
     } else if (parentScope != NULL) {
       return parentScope->getObject(name);
-    } else {
-      return environment->getObject(name);
+    } else if (auto index = environment->getObject(name)) {
+      return index;
+    } else if (enclosingScope == NULL) {
+      return environment->importObject(name);
+    }
+
+    auto index = enclosingScope->getObject(name);
+    // attributes of the instance a method was called on aren't
+    // registers of the enclosing scope.
+    if (index == NULL || index->indexType == OBJECT_PROPERTY) {
+      return NULL;
     }
+    return environment->addGlobal(name, index);
   }
 
-  GIndex* GScope::addClass(std::string name, VM::GType* type) {
+  GIndex* GScope::addClass(gstd::Symbol name, VM::GType* type) {
     if (parentScope == NULL) {
       return environment->addClass(name, type);
     } else {
@@ -51,23 +61,26 @@ namespace codegen {
     }
   }
 
-  GType* GScope::getClass(std::string name) {
+  GType* GScope::getClass(gstd::Symbol name) {
     GType* type = NULL;
 
-    if (typeIndexByName.find(name) != typeIndexByName.end()) {
-      type = environment->classes[typeIndexByName[name]];
+    if (auto typeIndex = typeIndexByName.find(name)) {
+      type = environment->classes[*typeIndex];
     } else if (parentScope != NULL) {
       type = parentScope->getClass(name);
     } else {
       type = environment->getClass(name);
+      if (type == NULL && enclosingScope != NULL) {
+        type = enclosingScope->getClass(name);
+      }
     }
 
     return type;
   }
 
-  GIndex* GScope::addFunction(std::string name, GFunction* func,
+  GIndex* GScope::addFunction(gstd::Symbol name, GFunction* func,
                               parser::PFunctionDeclaration* declaration) {
-    debug("Gsope::addFunction pushing back " << declaration->name);
+    debug("Gsope::addFunction pushing back " << gstd::symbolName(declaration->name));
     functionDeclarations.push_back(declaration);
     if (parentScope == NULL) {
       auto index = environment->addFunction(name, func);
@@ -84,26 +97,42 @@ namespace codegen {
 
 
   // function methods
-  GFunction* GScope::getFunction(std::string name) {
+  GFunction* GScope::getFunction(gstd::Symbol name) {
     GFunction* function = NULL;
-    if (functionsByName.find(name) != functionsByName.end()) {
-      function = environment->functions[functionsByName[name]];
+    if (auto functionIndex = functionsByName.find(name)) {
+      function = environment->functions[*functionIndex];
     } else if (parentScope != NULL) {
       debug("getting from parent");
       function = parentScope->getFunction(name);
     } else {
       debug("getting from env");
       function = environment->getFunction(name);
+      if (function == NULL && enclosingScope != NULL) {
+        function = enclosingScope->getFunction(name);
+      }
     }
     return function;
   }
 
+  GIndex* GScope::getSelf() {
+    if (self != NULL || parentScope == NULL) {
+      return self;
+    }
+    return parentScope->getSelf();
+  }
+
+  // a root scope gets an environment of its own. rather than copying
+  // in everything this scope can see, names are only brought in when
+  // the child refers to them.
   GScope* GScope::createChild(bool isRootScope) {
     GEnvironment* childEnvironment;
     GScope* parentScope = NULL;
+    GScope* enclosingScope = NULL;
 
     if (isRootScope) {
-      childEnvironment = createEnvironmentFromScope(this);
+      childEnvironment = new GEnvironment();
+      childEnvironment->parent = environment;
+      enclosingScope = this;
     } else {
       childEnvironment = environment;
       parentScope = this;
@@ -111,7 +140,8 @@ namespace codegen {
 
     auto scope = new GScope {
       .environment = childEnvironment,
-      .parentScope = parentScope
+      .parentScope = parentScope,
+      .enclosingScope = enclosingScope
     };
     debug("Y:  scope " << scope);
     debug("Y:  parentScope" << this);
@@ -121,98 +151,10 @@ namespace codegen {
   void GScope::finalize() {
     debug("GScope::finalize");
     for (auto& funcDecl : functionDeclarations) {
-      debug("  function name:" << funcDecl->name);
+      debug("  function name:" << gstd::symbolName(funcDecl->name));
       auto funcIndex = functionsByName[funcDecl->name];
       auto function = environment->functions[funcIndex];
       funcDecl->generateBody(function, this);
     }
   }
-
-  GEnvironment* createEnvironmentFromScope(GScope* scope) {
-    debug("YYY: create child was called");
-    std::map<std::string, int> functionsByName;
-    std::map<std::string, int> globalsByName;
-    auto globalsTypes = new std::vector<GType*>();
-    auto indicesInParent = new std::vector<int>();
-    int globalsCount = 0;
-
-    auto parentEnvironment = scope->environment;
-
-    // locals become globals
-    auto localsScope = scope;
-    while (localsScope != NULL) {
-      auto locals = localsScope->localsByName;
-      for (auto &kv : locals) {
-        if (globalsByName.find(kv.first) == globalsByName.end()) {
-          auto valIndex = kv.second->registerNum;
-          auto valType = parentEnvironment->localsTypes[valIndex];
-          indicesInParent->push_back(valIndex);
-          globalsTypes->push_back(valType);
-          globalsByName[kv.first] = globalsCount++;
-        }
-      }
-
-      for (auto &kv: localsScope->functionsByName) {
-        debug("Y: checking function " << kv.first);
-        if (functionsByName.find(kv.first) == functionsByName.end()) {
-          debug("Y: adding function " << kv.first);
-          functionsByName[kv.first] = kv.second;
-          debug("Y: done");
-        }
-      }
-
-      localsScope = localsScope->parentScope;
-    }
-
-    for (auto &kv: parentEnvironment->localsByName) {
-      debug("Y: checking " << kv.first);
-      if (globalsByName.find(kv.first) == globalsByName.end()) {
-        debug("Y: adding " << kv.first);
-        auto valIndex = kv.second;
-        auto valType = parentEnvironment->localsTypes[valIndex];
-        indicesInParent->push_back(kv.second);
-        globalsTypes->push_back(valType);
-        globalsByName[kv.first] = globalsCount++;
-      }
-    }
-
-    for (auto &kv: parentEnvironment->globalsByName) {
-      debug("Y: checking " << kv.first);
-      if (globalsByName.find(kv.first) == globalsByName.end()) {
-        debug("Y: adding " << kv.first);
-        auto valIndex = kv.second;
-        auto valType = parentEnvironment->globalsTypes[valIndex];
-        indicesInParent->push_back(-(kv.second + 1));
-        globalsTypes->push_back(valType);
-        globalsByName[kv.first] = globalsCount++;
-      }
-    }
-
-    for (auto &kv: parentEnvironment->functionsByName) {
-      if (functionsByName.find(kv.first) == functionsByName.end()) {
-        functionsByName[kv.first] = kv.second;
-      }
-    }
-
-    auto environment = new GEnvironment();
-    environment->globalsByName = globalsByName;
-    environment->globalsCount = globalsCount;
-    environment->functionsByName = functionsByName;
-    environment->functionsCount = functionsByName.size();
-
-    if (globalsCount > 0) {
-      environment->indicesInParent = &((*indicesInParent)[0]);
-      environment->globalsTypes = &((*globalsTypes)[0]);
-    }
-
-    environment->functions.insert(environment->functions.end(),
-                                  parentEnvironment->functions.begin(),
-                                  parentEnvironment->functions.end());
-
-    environment->classes.insert(environment->classes.end(),
-                                parentEnvironment->classes.begin(),
-                                parentEnvironment->classes.end());
-
-    return environment;
-  }
 }
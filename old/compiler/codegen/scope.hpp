@@ -22,31 +22,48 @@ namespace codegen {
   public:
     VM::GEnvironment* environment;
     GScope* parentScope;
+    // for the outermost scope of a function or class: the scope it
+    // was declared in. names that aren't found in the environment are
+    // looked up there, and become globals of the environment.
+    GScope* enclosingScope;
+    // in the body of a method: the register the instance it was
+    // called on is passed in.
+    VM::GIndex* self;
 
-    std::map<std::string, int> typeIndexByName;
-    std::map<std::string, VM::GIndex*> localsByName;
-    std::map<std::string, int> functionsByName;
+    gstd::SymbolMap<int> typeIndexByName;
+    gstd::SymbolMap<VM::GIndex*> localsByName;
+    gstd::SymbolMap<int> functionsByName;
     // I think these have to be the last attributes referenced.
     // if not, this causes weird compile errors in clang.
     // std::vector<GFunction*> functions;
     std::vector<parser::PFunctionDeclaration*> functionDeclarations;
 
-    VM::GIndex*    addObject(std::string name, VM::GType* type);
+    VM::GIndex*    addObject(gstd::Symbol name, VM::GType* type);
     VM::GIndex*    allocateObject(VM::GType* type);
-    VM::GIndex*    getObject(std::string name);
+    VM::GIndex*    getObject(gstd::Symbol name);
 
-    VM::GIndex*    addClass(std::string name, VM::GType* type);
-    VM::GType*     getClass(std::string name);
+    VM::GIndex*    addClass(gstd::Symbol name, VM::GType* type);
+    VM::GType*     getClass(gstd::Symbol name);
 
-    VM::GIndex*    addFunction(std::string name, VM::GFunction* func,
+    VM::GIndex*    addFunction(gstd::Symbol name, VM::GFunction* func,
                                parser::PFunctionDeclaration* declaration);
-    VM::GFunction* getFunction(std::string name);
+    VM::GFunction* getFunction(gstd::Symbol name);
+
+    VM::GIndex*    getSelf();
 
     GScope*        createChild(bool);
     void           finalize();
+
+    // scopes only last as long as the compile they're created for.
+    static void* operator new(size_t size) {
+      return VM::getCompilationArena().allocate(size, &destroy);
+    }
+    static void operator delete(void*) {}
+    static void destroy(void* scope) {
+      static_cast<GScope*>(scope)->~GScope();
+    }
   };
 
-  VM::GEnvironment* createEnvironmentFromScope(GScope*);
 }
 
 #endif
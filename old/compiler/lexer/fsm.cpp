@@ -1,4 +1,6 @@
 #include "fsm.hpp"
+#include "exceptions.hpp"
+#include <string.h>
 
 
 namespace lexer {
@@ -32,7 +34,7 @@ namespace lexer {
     }
   }
 
-  void FSMNode::addChild(std::string path, L result) {
+  void FSMNode::addChild(const std::string& path, L result) {
     addChildInternal(path.begin(), path.end(), result);
   }
 
@@ -42,7 +44,7 @@ namespace lexer {
       return BAD_TOKEN;
     }
 
-    FSMNode node = children[*it];
+    FSMNode& node = children[*it];
 
     if ((it + 1) == end) {
       return node.value;
@@ -51,8 +53,42 @@ namespace lexer {
     }
   }
 
-  L FSMNode::getValue(std::string path) {
+  L FSMNode::getValue(const std::string& path) {
     return getValueInternal(path.begin(), path.end());
   }
 
+  OperatorDFA::OperatorDFA(const KeywordPairVector& pairs) {
+    memset(transitions, 0, sizeof(transitions));
+    accepts[0] = BAD_TOKEN;
+    stateCount = 1;
+    for (auto& pair : pairs) {
+      int state = 0;
+      for (char c : pair.first) {
+        if (transitions[state][(int) c] == 0) {
+          if (stateCount == MAX_STATES) {
+            throw LexerException(0, "too many operator states for " + pair.first, "");
+          }
+          accepts[stateCount] = BAD_TOKEN;
+          transitions[state][(int) c] = stateCount++;
+        }
+        state = transitions[state][(int) c];
+      }
+      accepts[state] = pair.second;
+    }
+  }
+
+  KeywordTable::KeywordTable(const KeywordPairVector& pairs) {
+    for (int i = 0; i < KEYWORD_TABLE_SIZE; i++) {
+      entries[i].type = BAD_TOKEN;
+    }
+    for (auto& pair : pairs) {
+      auto& entry = entries[keywordHash(pair.first.data(), pair.first.size())];
+      if (entry.type != BAD_TOKEN) {
+        throw LexerException(0, "keyword " + pair.first + " collides with " + entry.name, "");
+      }
+      entry.name = pair.first;
+      entry.type = pair.second;
+    }
+  }
+
 }
@@ -11,7 +11,7 @@
 
 namespace lexer {
 
-  typedef std::string::iterator StringIter;
+  typedef std::string::const_iterator StringIter;
 
   class FSMNode {
 
@@ -30,8 +30,54 @@ namespace lexer {
 
     FSMNode addChildren(KeywordPairVector childrenPairs);
     bool hasChild(char childToken) { return children.find(childToken) != children.end(); }
-    void addChild(std::string path, L result);
-    L getValue(std::string path);
+    void addChild(const std::string& path, L result);
+    L getValue(const std::string& path);
+  };
+
+  // the same machine as an FSMNode tree, flattened into a transition
+  // table. the start state is never a target, so a transition to 0
+  // means there's nowhere left to go.
+  class OperatorDFA {
+  public:
+    static const int MAX_STATES = 64;
+    unsigned char transitions[MAX_STATES][128];
+    L accepts[MAX_STATES];
+    int stateCount;
+
+    OperatorDFA(const KeywordPairVector& pairs);
+    int next(int state, char c) {
+      return (unsigned char) c < 128 ? transitions[state][(int) c] : 0;
+    }
+  };
+
+  // keywords are found with a single probe, on a hash of their first
+  // and last characters and length. it's perfect for the keywords we
+  // have: adding one that collides fails when the table is built.
+  const int KEYWORD_TABLE_SIZE = 32;
+
+  constexpr int keywordHash(const char* start, int length) {
+    return ((start[0] + start[length - 1]) * 2 + length) & (KEYWORD_TABLE_SIZE - 1);
+  }
+
+  class KeywordTable {
+  private:
+    struct Entry {
+      std::string name;
+      L type;
+    };
+    Entry entries[KEYWORD_TABLE_SIZE];
+
+  public:
+    KeywordTable(const KeywordPairVector& pairs);
+    // BAD_TOKEN if the text isn't a keyword.
+    L find(const char* start, int length) {
+      auto& entry = entries[keywordHash(start, length)];
+      if (entry.type != BAD_TOKEN && (int) entry.name.size() == length &&
+          entry.name.compare(0, std::string::npos, start, length) == 0) {
+        return entry.type;
+      }
+      return BAD_TOKEN;
+    }
   };
 
 }
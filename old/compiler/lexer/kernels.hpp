@@ -0,0 +1,143 @@
+/*
+   scanning kernels for the runs of characters that make up most of a
+   source file: identifiers, comments, string literals and
+   indentation. each takes the start and end of the text to look at,
+   and returns where the run stops (end if it never does).
+
+   they look at a block of characters at a time where the compiler
+   gives us SSE2 or AVX2, and fall back to a character at a time
+   otherwise, and for whatever's left at the end of the buffer.
+ */
+#include "utils.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#define LEXER_SIMD
+#endif
+
+#ifndef LEXER_KERNELS_HPP
+#define LEXER_KERNELS_HPP
+
+namespace lexer {
+
+#ifdef LEXER_SIMD
+
+#ifdef __AVX2__
+  typedef __m256i Block;
+  const int BLOCK_SIZE = 32;
+  const unsigned FULL_BLOCK = 0xffffffff;
+
+  inline Block loadBlock(const char* p) { return _mm256_loadu_si256((const Block*) p); }
+  inline Block splat(char c) { return _mm256_set1_epi8(c); }
+  inline Block blockEq(Block a, Block b) { return _mm256_cmpeq_epi8(a, b); }
+  inline Block blockGt(Block a, Block b) { return _mm256_cmpgt_epi8(a, b); }
+  inline Block blockOr(Block a, Block b) { return _mm256_or_si256(a, b); }
+  inline Block blockAnd(Block a, Block b) { return _mm256_and_si256(a, b); }
+  inline unsigned blockMask(Block a) { return (unsigned) _mm256_movemask_epi8(a); }
+#else
+  typedef __m128i Block;
+  const int BLOCK_SIZE = 16;
+  const unsigned FULL_BLOCK = 0xffff;
+
+  inline Block loadBlock(const char* p) { return _mm_loadu_si128((const Block*) p); }
+  inline Block splat(char c) { return _mm_set1_epi8(c); }
+  inline Block blockEq(Block a, Block b) { return _mm_cmpeq_epi8(a, b); }
+  inline Block blockGt(Block a, Block b) { return _mm_cmpgt_epi8(a, b); }
+  inline Block blockOr(Block a, Block b) { return _mm_or_si128(a, b); }
+  inline Block blockAnd(Block a, Block b) { return _mm_and_si128(a, b); }
+  inline unsigned blockMask(Block a) { return (unsigned) _mm_movemask_epi8(a); }
+#endif
+
+  // comparisons are signed, so characters past 127 are never in range.
+  inline Block inRange(Block block, char low, char high) {
+    return blockAnd(blockGt(block, splat(low - 1)), blockGt(splat(high + 1), block));
+  }
+
+  // a bit set for every character of the block that can be part of
+  // an identifier.
+  inline unsigned identifierMask(Block block) {
+    // setting 0x20 lowercases letters, without making anything else
+    // look like one.
+    auto lower = blockOr(block, splat(0x20));
+    return blockMask(blockOr(blockOr(inRange(lower, 'a', 'z'),
+                                     inRange(block, '0', '9')),
+                             blockEq(block, splat('_'))));
+  }
+
+  inline unsigned matchMask(Block block, char c) {
+    return blockMask(blockEq(block, splat(c)));
+  }
+
+  inline int firstSet(unsigned mask) {
+    return __builtin_ctz(mask);
+  }
+#endif
+
+  // the end of a run of letters, numbers and underscores.
+  inline const char* skipIdentifier(const char* p, const char* end) {
+#ifdef LEXER_SIMD
+    for (; end - p >= BLOCK_SIZE; p += BLOCK_SIZE) {
+      auto mask = identifierMask(loadBlock(p));
+      if (mask != FULL_BLOCK) {
+        return p + firstSet(~mask);
+      }
+    }
+#endif
+    while (p != end && isAlphaNumeric(*p)) {
+      p++;
+    }
+    return p;
+  }
+
+  // the next newline, for skipping over comments.
+  inline const char* findNewline(const char* p, const char* end) {
+#ifdef LEXER_SIMD
+    for (; end - p >= BLOCK_SIZE; p += BLOCK_SIZE) {
+      auto mask = matchMask(loadBlock(p), '\n');
+      if (mask != 0) {
+        return p + firstSet(mask);
+      }
+    }
+#endif
+    while (p != end && *p != '\n') {
+      p++;
+    }
+    return p;
+  }
+
+  // the next character in a string literal that isn't part of its
+  // text: the closing quote, or the start of an escape.
+  inline const char* findStringEnd(const char* p, const char* end) {
+#ifdef LEXER_SIMD
+    for (; end - p >= BLOCK_SIZE; p += BLOCK_SIZE) {
+      auto block = loadBlock(p);
+      auto mask = matchMask(block, '"') | matchMask(block, '\\');
+      if (mask != 0) {
+        return p + firstSet(mask);
+      }
+    }
+#endif
+    while (p != end && *p != '"' && *p != '\\') {
+      p++;
+    }
+    return p;
+  }
+
+  // the end of the tabs a line is indented with.
+  inline const char* skipTabs(const char* p, const char* end) {
+#ifdef LEXER_SIMD
+    for (; end - p >= BLOCK_SIZE; p += BLOCK_SIZE) {
+      auto mask = matchMask(loadBlock(p), '\t');
+      if (mask != FULL_BLOCK) {
+        return p + firstSet(~mask);
+      }
+    }
+#endif
+    while (p != end && *p == '\t') {
+      p++;
+    }
+    return p;
+  }
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include <string>
 #include <iostream>
+#include <iterator>
 #include "exceptions.hpp"
 
 #ifndef SCANNER_HPP
@@ -13,37 +14,68 @@ namespace lexer {
     virtual ~StringScannerException() throw () {}
   };
 
+  /*
+    walks a buffer of source text a character at a time. streams are
+    read into a buffer of the scanner's own up front, so scanning
+    never goes through the stream.
+   */
   class StringScanner {
   private:
-    std::istream& source;
+    std::string buffer;
+    const char* current;
+    const char* end;
 
     void validateNextTokenExists() {
-      if (source.peek() == EOF) {
+      if (current == end) {
         throw StringScannerException("No next token exists!");
       }
     }
 
   public:
 
-    StringScanner(std::istream& _source) :
-      source(_source) {}
+    StringScanner(std::istream& source) :
+      buffer(std::istreambuf_iterator<char>(source),
+             std::istreambuf_iterator<char>()),
+      current(buffer.data()), end(buffer.data() + buffer.size()) {}
+
+    // the buffer has to outlive the scanner.
+    StringScanner(const char* begin, const char* _end) :
+      current(begin), end(_end) {}
 
     char peek() {
       validateNextTokenExists();
-      return source.peek();
+      return *current;
     }
 
     char next() {
       validateNextTokenExists();
-      return source.get();
+      return *current++;
     }
 
     void back() {
-      source.unget();
+      current--;
     }
 
     bool hasNext() {
-      return (source.peek() != EOF);
+      return current != end;
+    }
+
+    // where the next character is in the buffer.
+    const char* position() {
+      return current;
+    }
+
+    int remaining() {
+      return end - current;
+    }
+
+    const char* bufferEnd() {
+      return end;
+    }
+
+    // jump ahead to a position found by looking at the buffer directly.
+    void skipTo(const char* position) {
+      current = position;
     }
 
   };
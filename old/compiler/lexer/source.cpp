@@ -0,0 +1,47 @@
+#include "source.hpp"
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace lexer;
+
+SourceBuffer* SourceBuffer::open(std::string path) {
+  auto source = new SourceBuffer();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  struct stat info;
+  if (fd >= 0 && fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    auto mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      close(fd);
+      source->mappedSize = info.st_size;
+      source->begin = (const char*) mapping;
+      source->end = source->begin + info.st_size;
+      return source;
+    }
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+
+  // pipes, empty files, or anything else that can't be mapped.
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    delete source;
+    throw SourceException("unable to open " + path);
+  }
+  std::stringstream contents;
+  contents << input.rdbuf();
+  source->contents = contents.str();
+  source->begin = source->contents.data();
+  source->end = source->begin + source->contents.size();
+  return source;
+}
+
+SourceBuffer::~SourceBuffer() {
+  if (mappedSize > 0) {
+    munmap((void*) begin, mappedSize);
+  }
+}
@@ -0,0 +1,37 @@
+#include <string>
+#include "../exceptions.hpp"
+
+#ifndef LEXER_SOURCE_HPP
+#define LEXER_SOURCE_HPP
+
+namespace lexer {
+
+  class SourceException : public core::GreyhawkException {
+  public:
+    SourceException(std::string _message): core::GreyhawkException(_message) {}
+    virtual ~SourceException() throw () {}
+  };
+
+  /*
+    the contents of a source file, as a single contiguous buffer the
+    scanner can walk with a pointer. the file is memory mapped when
+    possible, and read in one go otherwise.
+   */
+  class SourceBuffer {
+  public:
+    const char* begin;
+    const char* end;
+
+    static SourceBuffer* open(std::string path);
+    ~SourceBuffer();
+
+  private:
+    // the length of the mapping, or 0 if the file was read instead.
+    size_t mappedSize;
+    std::string contents;
+
+    SourceBuffer() : begin(NULL), end(NULL), mappedSize(0) {}
+  };
+}
+
+#endif
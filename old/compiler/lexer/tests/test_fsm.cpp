@@ -34,3 +34,29 @@ TEST(LexerFSM, addChildren) {
   EXPECT_EQ(root.getValue("ab"), IF);
   EXPECT_EQ(root.getValue("ac"), ELSE);
 }
+
+TEST(LexerFSM, operatorDFA) {
+  KeywordPairVector pairs {
+      KeywordPair("=", ASSIGN),
+      KeywordPair("==", EQUAL),
+      KeywordPair(":=", DECLARE)
+  };
+  OperatorDFA dfa(pairs);
+  int assign = dfa.next(0, '=');
+  EXPECT_EQ(dfa.accepts[assign], ASSIGN);
+  EXPECT_EQ(dfa.accepts[dfa.next(assign, '=')], EQUAL);
+  // ':' alone isn't an operator here.
+  int colon = dfa.next(0, ':');
+  EXPECT_EQ(dfa.accepts[colon], BAD_TOKEN);
+  EXPECT_EQ(dfa.accepts[dfa.next(colon, '=')], DECLARE);
+  EXPECT_EQ(dfa.next(0, '!'), 0);
+}
+
+TEST(LexerFSM, keywordTable) {
+  KeywordTable keywords(keywordList);
+  for (auto& pair : keywordList) {
+    EXPECT_EQ(keywords.find(pair.first.data(), pair.first.size()), pair.second);
+  }
+  EXPECT_EQ(keywords.find("iff", 3), BAD_TOKEN);
+  EXPECT_EQ(keywords.find("i", 1), BAD_TOKEN);
+}
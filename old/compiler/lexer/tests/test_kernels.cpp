@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include "../kernels.hpp"
+#include <string>
+
+using namespace lexer;
+
+// runs long enough to cross a few blocks, stopping at every offset,
+// so both the block and the character at a time paths are covered.
+TEST(Kernels, skipIdentifier) {
+  for (int length = 0; length < 80; length++) {
+    std::string source = std::string(length, 'a') + "(" + std::string(40, 'b');
+    auto begin = source.data();
+    EXPECT_EQ(skipIdentifier(begin, begin + source.size()), begin + length);
+  }
+  std::string mixed = "aZ_09azAZ_" + std::string(30, 'x') + "\xe9";
+  auto begin = mixed.data();
+  EXPECT_EQ(skipIdentifier(begin, begin + mixed.size()), begin + mixed.size() - 1);
+}
+
+TEST(Kernels, findNewline) {
+  for (int length = 0; length < 80; length++) {
+    std::string source = std::string(length, ' ') + "\n" + std::string(40, ' ');
+    auto begin = source.data();
+    EXPECT_EQ(findNewline(begin, begin + source.size()), begin + length);
+  }
+  std::string comment(50, '/');
+  EXPECT_EQ(findNewline(comment.data(), comment.data() + 50), comment.data() + 50);
+}
+
+TEST(Kernels, findStringEnd) {
+  for (int length = 0; length < 80; length++) {
+    std::string source = std::string(length, 'a') + (length % 2 ? "\"" : "\\") + "aaaa";
+    auto begin = source.data();
+    EXPECT_EQ(findStringEnd(begin, begin + source.size()), begin + length);
+  }
+}
+
+TEST(Kernels, skipTabs) {
+  for (int length = 0; length < 80; length++) {
+    std::string source = std::string(length, '\t') + "x" + std::string(40, '\t');
+    auto begin = source.data();
+    EXPECT_EQ(skipTabs(begin, begin + source.size()), begin + length);
+  }
+}
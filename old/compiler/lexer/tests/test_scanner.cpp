@@ -14,3 +14,15 @@ TEST(Scanner, validate) {
   EXPECT_EQ(s.next(), 's');
   EXPECT_EQ(s.next(), 't');
 }
+
+TEST(Scanner, buffer) {
+  const char* source = "ab";
+  StringScanner s(source, source + 2);
+  EXPECT_EQ(s.peek(), 'a');
+  EXPECT_EQ(s.next(), 'a');
+  EXPECT_EQ(s.next(), 'b');
+  EXPECT_FALSE(s.hasNext());
+  EXPECT_THROW(s.next(), StringScannerException);
+  s.back();
+  EXPECT_EQ(s.next(), 'b');
+}
@@ -10,6 +10,22 @@ TEST(Tokenizer, tokenize) {
   istringstream input_stream("== =");
   TokenVector tokens = tokenizer.tokenize(input_stream);
   EXPECT_EQ(tokens.size(), 2);
-  EXPECT_EQ(EQUAL, tokens[0]->type);
-  EXPECT_EQ(ASSIGN, tokens[1]->type);
+  EXPECT_EQ(EQUAL, tokens[0].type);
+  EXPECT_EQ(ASSIGN, tokens[1].type);
+}
+
+// tokens point back into the source, and literals are unescaped
+// when their value is asked for.
+TEST(Tokenizer, views) {
+  Tokenizer tokenizer;
+  istringstream input_stream("foo := \"a\\\"b\"");
+  TokenVector tokens = tokenizer.tokenize(input_stream);
+  EXPECT_EQ(tokens.size(), 3);
+  EXPECT_EQ(IDENTIFIER, tokens[0].type);
+  EXPECT_EQ("foo", tokens[0].value());
+  EXPECT_EQ(1, tokens[0].column);
+  // literals start after their opening quote.
+  EXPECT_EQ(9, tokens[2].column);
+  EXPECT_EQ(4, tokens[2].length);
+  EXPECT_EQ("a\"b", tokens[2].value());
 }
@@ -6,3 +6,13 @@ using namespace lexer;
 TEST(Lexer, isAlpha) {
   EXPECT_TRUE (isAlpha('t'));
 }
+
+TEST(Lexer, charClasses) {
+  EXPECT_TRUE(isAlpha('_'));
+  EXPECT_FALSE(isAlpha('1'));
+  EXPECT_TRUE(isAlphaNumeric('1'));
+  EXPECT_TRUE(isCapital('Q'));
+  EXPECT_FALSE(isCapital('q'));
+  EXPECT_TRUE(isTokenBreakCharacter('\t'));
+  EXPECT_FALSE(isAlphaNumeric((char) 0xe9));
+}
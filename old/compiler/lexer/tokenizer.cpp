@@ -6,23 +6,38 @@
 using namespace lexer;
 using std::string;
 
-FSMNode& lexer::getOperatorFSMRoot() {
-  static FSMNode root(' ', BAD_TOKEN);
-  static bool initialized = false;
-  if (!initialized) {
-    initialized = true;
-    root.addChildren(operatorPairs);
-  }
-  return root;
+OperatorDFA& lexer::getOperatorDFA() {
+  static OperatorDFA dfa(operatorPairs);
+  return dfa;
+}
+
+KeywordTable& lexer::getKeywordTable() {
+  static KeywordTable keywords(keywordList);
+  return keywords;
 }
 
 TokenVector Tokenizer::tokenize(std::istream& input) {
+  auto source = std::make_shared<std::string>(std::istreambuf_iterator<char>(input),
+                                             std::istreambuf_iterator<char>());
+  StringScanner scanner(source->data(), source->data() + source->size());
+  auto tokens = tokenize(scanner);
+  tokens.source = source;
+  return tokens;
+}
+
+TokenVector Tokenizer::tokenize(SourceBuffer& source) {
+  StringScanner scanner(source.begin, source.end);
+  return tokenize(scanner);
+}
+
+TokenVector Tokenizer::tokenize(StringScanner& scanner) {
   int line = 0;
-  StringScanner scanner(input);
   TokenVector tokens;
+  // a guess, so the tokens are rarely copied as they're added.
+  tokens.reserve(scanner.remaining() / 4 + 16);
   bool isNewLine = true;
-  bool isComment = false;
   initialize();
+  lineStart = scanner.position();
 
   while (scanner.hasNext()) {
 
@@ -42,8 +57,8 @@ TokenVector Tokenizer::tokenize(std::istream& input) {
       }
 
       line++;
+      lineStart = scanner.position();
       isNewLine = false;
-      isComment = false;
       calculateIndent(scanner, tokens, line);
 
 
@@ -55,50 +70,55 @@ TokenVector Tokenizer::tokenize(std::istream& input) {
       isNewLine = true;
       scanner.next();
 
-    } else if (isComment) {
-      scanner.next();
-
     } else if (scanner.peek() == '/') {
       scanner.next();
       if (scanner.peek() == '/') {
-        scanner.next();
-        isComment = true;
+        // comments run to the end of the line.
+        scanner.skipTo(findNewline(scanner.position(), scanner.bufferEnd()));
       } else {
         scanner.back();
-        tokens.push_back(&matchOperator(scanner, line));
+        tokens.push_back(matchOperator(scanner, line));
       }
 
     } else if (scanner.peek() == '\'') {
-      char* values = new char[1];
+      // literals are left escaped in the source, and resolved when
+      // their value is asked for.
       scanner.next();
-      values[0] = parseChar(scanner, line);
+      auto start = scanner.position();
+      parseChar(scanner, line);
+      auto end = scanner.position();
       if (scanner.peek() != '\'') {
         throw LexerException(line, "expected a single quote, to close a character definition", "");
       }
       scanner.next();
-      tokens.push_back(new Token(CHAR, line, values));
+      tokens.push_back(makeToken(CHAR, line, start, end));
 
     } else if (scanner.peek() == '"') {
-      std::string output;
       scanner.next();
-      while(scanner.peek() != '"') {
-        output.push_back(parseChar(scanner, line));
+      auto start = scanner.position();
+      while (true) {
+        scanner.skipTo(findStringEnd(scanner.position(), scanner.bufferEnd()));
+        if (scanner.peek() == '"') {
+          break;
+        }
+        parseChar(scanner, line);
       }
+      auto end = scanner.position();
       scanner.next();
-      tokens.push_back(new Token(STRING, line, output));
+      tokens.push_back(makeToken(STRING, line, start, end));
 
     } else if (isNumeric(scanner.peek())) {
       // then it's a number
-      tokens.push_back(&matchNumber(scanner, line));
+      tokens.push_back(matchNumber(scanner, line));
 
     } else if (isAlpha(scanner.peek())) {
       // if the next character is alphanumeric,
       // we pass it to the keyword matcher
-      tokens.push_back(&matchKeyword(scanner, line));
+      tokens.push_back(matchKeyword(scanner, line));
 
     } else {
       // if it's not, we pass it to our operatorFSM
-      tokens.push_back(&matchOperator(scanner, line));
+      tokens.push_back(matchOperator(scanner, line));
     }
   }
   clearIndent(tokens, line);
@@ -109,6 +129,20 @@ void Tokenizer::initialize() {
   indentation = 0;
 }
 
+// a token starting at start. tokens with a value view the text from
+// start to end.
+Token Tokenizer::makeToken(L type, int line, const char* start, const char* end) {
+  return Token {
+    .type = type,
+    .line = line,
+    .column = (int) (start - lineStart) + 1,
+    .length = end == NULL ? 0 : (int) (end - start),
+    .text = end == NULL ? NULL : start,
+    .symbol = (type == IDENTIFIER || type == TYPE) ?
+      gstd::intern(start, end - start) : gstd::NO_SYMBOL
+  };
+}
+
 char Tokenizer::parseChar(StringScanner& scanner, int line) {
   if (scanner.peek() != '\\') {
     return scanner.next();
@@ -129,14 +163,21 @@ char Tokenizer::parseChar(StringScanner& scanner, int line) {
   }
 }
 
-const Token& Tokenizer::matchOperator(StringScanner& scanner, int line) {
-  FSMNode* current_node = &getOperatorFSMRoot();
+Token Tokenizer::matchOperator(StringScanner& scanner, int line) {
+  auto& dfa = getOperatorDFA();
+  auto start = scanner.position();
+  int state = 0;
 
-  while (scanner.hasNext() && current_node->hasChild(scanner.peek())) {
-    current_node = &(current_node->children[scanner.next()]);
+  while (scanner.hasNext()) {
+    int next = dfa.next(state, scanner.peek());
+    if (next == 0) {
+      break;
+    }
+    state = next;
+    scanner.next();
   }
 
-  if (current_node->value == BAD_TOKEN) {
+  if (dfa.accepts[state] == BAD_TOKEN) {
 
     if (scanner.hasNext()) {
       throw LexerException(line,
@@ -149,50 +190,31 @@ const Token& Tokenizer::matchOperator(StringScanner& scanner, int line) {
     }
 
   } else {
-    return *new Token(current_node->value, line);
+    return makeToken(dfa.accepts[state], line, start, NULL);
   }
 }
 
-const Token& Tokenizer::matchKeyword(StringScanner& scanner, int line) {
-  string current_token("");
-  bool startsWithCapital = false;
-  bool containsNonStartingCapital = false;
-
-  char firstToken = scanner.next();
-  if (isCapital(firstToken)) {
-    startsWithCapital = true;
-  }
-
-  current_token += firstToken;
-
-  while (scanner.hasNext()) {
-    char next = scanner.peek();
-
-    if (isTokenBreakCharacter(next) || !isAlphaNumeric(next)) {
-      break;
-    }
+Token Tokenizer::matchKeyword(StringScanner& scanner, int line) {
+  auto start = scanner.position();
+  bool startsWithCapital = isCapital(scanner.next());
 
-    if (isCapital(next)) {
-      containsNonStartingCapital = true;
-    }
-    current_token += scanner.next();
-  }
+  scanner.skipTo(skipIdentifier(scanner.position(), scanner.bufferEnd()));
 
-  for (KeywordPairVector::const_iterator it = keywordList.begin(); it != keywordList.end(); ++it) {
-    if (current_token.compare(it->first) == 0) {
-      return *new Token(it->second, line);
-    }
+  auto end = scanner.position();
+  L keyword = getKeywordTable().find(start, end - start);
+  if (keyword != BAD_TOKEN) {
+    return makeToken(keyword, line, start, NULL);
   }
 
   if (startsWithCapital) {
-    return *new Token(TYPE, line, current_token);
+    return makeToken(TYPE, line, start, end);
   }
 
-  return *new Token(IDENTIFIER, line, current_token);
+  return makeToken(IDENTIFIER, line, start, end);
 }
 
-const Token& Tokenizer::matchNumber(StringScanner& scanner, int line) {
-  string current_token("");
+Token Tokenizer::matchNumber(StringScanner& scanner, int line) {
+  auto start = scanner.position();
   bool isDouble = false;
   while(scanner.hasNext()) {
     char c = scanner.peek();
@@ -207,34 +229,27 @@ const Token& Tokenizer::matchNumber(StringScanner& scanner, int line) {
       break;
 
     }
-    current_token += c;
     scanner.next();
   }
 
-  if (isDouble) {
-    return *(new Token(DOUBLE, line, current_token));
-  } else {
-    return *(new Token(INT, line, current_token));
-  }
+  return makeToken(isDouble ? DOUBLE : INT, line, start, scanner.position());
 }
 
 
 void Tokenizer::calculateIndent(StringScanner& scanner, TokenVector& tokens, int line) {
 
-  int current_indentation = 0;
-  while (scanner.hasNext() && scanner.peek() == '\t') {
-    current_indentation++;
-    scanner.next();
-  }
+  auto start = scanner.position();
+  scanner.skipTo(skipTabs(start, scanner.bufferEnd()));
+  int current_indentation = scanner.position() - start;
 
   while (indentation > current_indentation) {
     indentation--;
-    tokens.push_back(new Token(UNINDENT, line));
+    tokens.push_back(makeToken(UNINDENT, line, lineStart, NULL));
   }
 
   while (indentation < current_indentation) {
     indentation++;
-    tokens.push_back(new Token(INDENT, line));
+    tokens.push_back(makeToken(INDENT, line, lineStart, NULL));
   }
 
   if (scanner.peek() == ' ') {
@@ -247,6 +262,6 @@ void Tokenizer::calculateIndent(StringScanner& scanner, TokenVector& tokens, int
 void Tokenizer::clearIndent(TokenVector& tokens, int line) {
   while(indentation > 0) {
     indentation--;
-    tokens.push_back(new Token(UNINDENT, line));
+    tokens.push_back(makeToken(UNINDENT, line, lineStart, NULL));
   }
 }
@@ -2,8 +2,10 @@
 #include "exceptions.hpp"
 #include "tokens.hpp"
 #include "scanner.hpp"
+#include "source.hpp"
 #include "fsm.hpp"
 #include "utils.hpp"
+#include "kernels.hpp"
 
 #ifndef LEXER_TOKENIZER_HPP
 #define LEXER_TOKENIZER_HPP
@@ -13,19 +15,25 @@ namespace lexer {
   class Tokenizer {
   private:
     int indentation;
+    // where the line being scanned starts, for the columns of tokens.
+    const char* lineStart;
     void initialize();
-    static const Token& matchKeyword(StringScanner& scanner, int line);
-    const Token& matchOperator(StringScanner& scanner, int line);
-    static const Token& matchNumber(StringScanner& scanner, int line);
+    Token makeToken(L type, int line, const char* start, const char* end);
+    Token matchKeyword(StringScanner& scanner, int line);
+    Token matchOperator(StringScanner& scanner, int line);
+    Token matchNumber(StringScanner& scanner, int line);
     char parseChar(StringScanner&, int line);
     void calculateIndent(StringScanner& scanner, TokenVector& tokens, int line);
     void clearIndent(TokenVector& tokens, int line);
+    TokenVector tokenize(StringScanner& scanner);
   public:
     Tokenizer() {};
     TokenVector tokenize(std::istream& input);
+    TokenVector tokenize(SourceBuffer& source);
   };
 
-  FSMNode& getOperatorFSMRoot();
+  OperatorDFA& getOperatorDFA();
+  KeywordTable& getKeywordTable();
 }
 
 #endif
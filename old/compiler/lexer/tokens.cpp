@@ -1,4 +1,5 @@
 #include "tokens.hpp"
+#include <stdio.h>
 
 namespace lexer {
 
@@ -49,6 +50,49 @@ namespace lexer {
     {WHILE, "while"}
   };
 
+  // the character an escape sequence (without its backslash) stands
+  // for.
+  static char unescape(char escaped) {
+    switch (escaped) {
+    case '0':
+      return EOF;
+    default:
+      return escaped;
+    }
+  }
+
+  std::string Token::value() const {
+    if (text == NULL) {
+      return "";
+    }
+    if (type != STRING && type != CHAR) {
+      return std::string(text, length);
+    }
+    std::string output;
+    output.reserve(length);
+    for (int i = 0; i < length; i++) {
+      if (text[i] == '\\' && i + 1 < length) {
+        output.push_back(unescape(text[++i]));
+      } else {
+        output.push_back(text[i]);
+      }
+    }
+    return output;
+  }
+
+  std::string Token::getDescription() const {
+    auto output_string = tokenMap.find(type) != tokenMap.begin() ? tokenMap[type] : "token";
+    auto tokenValue = value();
+    if (tokenValue != "") {
+      output_string += ": " + tokenValue;
+    }
+    return output_string;
+  }
+
+  std::string Token::getFullDescription() const {
+    return "line " + std::to_string(line) + ": " + getDescription();
+  }
+
   KeywordPair& pairFromType(L type) {
     return *new KeywordPair(tokenMap[type], type);
   }
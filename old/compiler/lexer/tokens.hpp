@@ -1,7 +1,8 @@
 #include <string>
-kikkiklol
 #include <vector>
 #include <map>
+#include <memory>
+#include "../std/symbols.hpp"
 
 #ifndef LEXER_TOKEN_HPP
 #define LEXER_TOKEN_HPP
@@ -68,31 +69,36 @@ namespace lexer {
   extern std::map<L, std::string> tokenMap;
   extern std::map<L, int> opPrecedence;
 
-  class Token {
-  public:
-    const L type;
-    const int line;
-    const std::string value;
-    Token(L _type, int _line) : Token(_type, _line, "") {}
-    Token(L _type, int _line, std::string _value) :
-      type(_type), line(_line), value(_value)  {}
-    virtual ~Token() {}
-
-    virtual std::string getDescription() const {
-      auto output_string = tokenMap.find(type) != tokenMap.begin() ? tokenMap[type] : "token";
-      if (value != "") {
-        output_string += ": " + value;
-      }
-      return output_string;
-    }
-
-    virtual std::string getFullDescription() const {
-      return "line " + std::to_string(line) + ": " + getDescription();
-    }
+  /*
+    tokens are plain records, stored by value one after another. the
+    text of identifiers, types and literals isn't copied: the token
+    views it in the source it was scanned from, which has to outlive
+    the token.
+   */
+  struct Token {
+    L type;
+    int line;
+    int column;
+    int length;
+    // NULL for tokens that don't carry a value, like operators.
+    const char* text;
+    // identifiers and types are interned as they're scanned.
+    gstd::Symbol symbol;
 
+    // the text of the token, with the escapes of string and char
+    // literals resolved.
+    std::string value() const;
+    std::string getDescription() const;
+    std::string getFullDescription() const;
   };
 
-  typedef std::vector<const Token*> TokenVector;
+  // tokens view the text they were scanned from. text read from a
+  // stream is owned by its tokens, so it's released along with them
+  // once they're parsed, rather than kept for every line of a repl.
+  class TokenVector: public std::vector<Token> {
+  public:
+    std::shared_ptr<std::string> source;
+  };
 
   typedef std::pair<std::string, L> KeywordPair;
   typedef std::vector<KeywordPair> KeywordPairVector;
@@ -5,36 +5,59 @@
 
 namespace lexer {
 
+  // every character the lexer cares about is classified up front, so
+  // checking a character is a single lookup.
+  enum CharClass {
+    CHAR_ALPHA = 1,
+    CHAR_NUMERIC = 2,
+    CHAR_CAPITAL = 4,
+    CHAR_BREAK = 8,
+  };
+
+  constexpr unsigned char classifyChar(int c) {
+    return (('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_' ? CHAR_ALPHA : 0) |
+      ('0' <= c && c <= '9' ? CHAR_NUMERIC : 0) |
+      ('A' <= c && c <= 'Z' ? CHAR_CAPITAL : 0) |
+      (c == ' ' || c == '\n' || c == '\t' ? CHAR_BREAK : 0);
+  }
+
+#define CHAR_CLASS_ROW(n)                                               \
+  classifyChar(n), classifyChar(n + 1), classifyChar(n + 2), classifyChar(n + 3), \
+  classifyChar(n + 4), classifyChar(n + 5), classifyChar(n + 6), classifyChar(n + 7), \
+  classifyChar(n + 8), classifyChar(n + 9), classifyChar(n + 10), classifyChar(n + 11), \
+  classifyChar(n + 12), classifyChar(n + 13), classifyChar(n + 14), classifyChar(n + 15)
+
+  constexpr unsigned char charClasses[256] = {
+    CHAR_CLASS_ROW(0), CHAR_CLASS_ROW(16), CHAR_CLASS_ROW(32), CHAR_CLASS_ROW(48),
+    CHAR_CLASS_ROW(64), CHAR_CLASS_ROW(80), CHAR_CLASS_ROW(96), CHAR_CLASS_ROW(112),
+    CHAR_CLASS_ROW(128), CHAR_CLASS_ROW(144), CHAR_CLASS_ROW(160), CHAR_CLASS_ROW(176),
+    CHAR_CLASS_ROW(192), CHAR_CLASS_ROW(208), CHAR_CLASS_ROW(224), CHAR_CLASS_ROW(240),
+  };
+
+#undef CHAR_CLASS_ROW
+
+  inline bool hasCharClass(char c, int charClass) {
+    return charClasses[(unsigned char) c] & charClass;
+  }
+
   inline bool isAlpha(char c) {
-    if ('a' <= c && c <= 'z') {
-      return true;
-    } else if ('A' <= c && c <= 'Z') {
-      return true;
-    } else if (c == '_') {
-      return true;
-    }
-    return false;
+    return hasCharClass(c, CHAR_ALPHA);
   }
 
   inline bool isNumeric(char c) {
-    return '0' <= c && c <= '9';
+    return hasCharClass(c, CHAR_NUMERIC);
   }
 
   inline bool isCapital(char c) {
-    return 'A' <= c && c <= 'Z';
+    return hasCharClass(c, CHAR_CAPITAL);
   }
 
   inline bool isAlphaNumeric(char c) {
-    return isAlpha(c) || isNumeric(c);
+    return hasCharClass(c, CHAR_ALPHA | CHAR_NUMERIC);
   }
 
   inline bool isTokenBreakCharacter(char c) {
-    static const std::vector<char> breakChar {' ', '\n', '\t'};
-
-    for (auto it = breakChar.begin(); it != breakChar.end(); ++it) {
-      if ((*it) == c) { return true; }
-    }
-    return false;
+    return hasCharClass(c, CHAR_BREAK);
   }
 }
 
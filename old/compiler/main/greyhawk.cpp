@@ -3,11 +3,14 @@
 #include "../lexer/tokenizer.hpp"
 #include "../vm/vm.hpp"
 #include "../vm/execution_engine.hpp"
+#include "../vm/exception.hpp"
+#include "../vm/module_cache.hpp"
 #include "../parser/parser.hpp"
 #include "../codegen/scope.hpp"
+#include "../codegen/passes.hpp"
 #include <boost/program_options.hpp>
+#include <chrono>
 #include <sstream>
-#include <fstream>
 
 namespace po = boost::program_options;
 using namespace lexer;
@@ -20,6 +23,23 @@ using namespace VM;
   #define debug(s);
 #endif
 
+typedef std::chrono::steady_clock::time_point GTime;
+
+// as close to the start of the process as the binary can see: before
+// any other static is initialized.
+static const GTime processStart __attribute__((init_priority(101))) =
+  std::chrono::steady_clock::now();
+
+// when each step of starting up finished, for --startup-stats.
+typedef struct StartupTimes {
+  GTime main;
+  GTime arguments;
+  GTime rootEnvironment;
+  GTime module;
+  GTime firstInstruction;
+} StartupTimes;
+static StartupTimes startupTimes;
+
 // these are initialized in main
 static Tokenizer* tokenizer;
 static GEnvironment* globalScope;
@@ -31,13 +51,36 @@ typedef struct CommandLineArguments {
   bool ast;
   bool bytecode;
   bool llvm;
+  int stackSize;
+  int optimizationLevel;
+  bool gcStats;
+  bool startupStats;
+  // whether compiled modules are saved, and loaded again if the
+  // source hasn't changed.
+  bool cache;
+  bool compileOnly;
+  // the snapshot the root environment is loaded from, and the one it's
+  // saved to once the file has run.
+  std::string snapshot;
+  std::string writeSnapshot;
 } CommandLineArguments;
 
+// -O and -O<n> are read here, rather than as a short option with an
+// implicit value, which would take the file name after -O as its level.
+std::pair<std::string, std::string> parseOptimizeFlag(const std::string& token) {
+  if (token.compare(0, 2, "-O") == 0) {
+    return std::make_pair("optimize", token.size() == 2 ? "1" : token.substr(2));
+  }
+  return std::make_pair(std::string(), std::string());
+}
+
 CommandLineArguments& getArguments(int argc, char*argv[]) {
 
   CommandLineArguments* args = new CommandLineArguments();
   args->ast = false;
   args->llvm = false;
+  args->stackSize = 64;
+  args->optimizationLevel = 0;
 
   po::positional_options_description posixOptions;
   posixOptions.add("file_name", 1);
@@ -46,6 +89,14 @@ CommandLineArguments& getArguments(int argc, char*argv[]) {
     ("help", "Print help message")
     ("ast", "print the ast")
     ("bytecode", "print the bytecode")
+    ("stack-size", po::value<int>(), "the size of the vm stack, in megabytes (default 64)")
+    ("optimize", po::value<int>(), "optimize the bytecode (-O<n> for short, -O is -O1, default 0)")
+    ("gc-stats", "print garbage collector statistics on exit")
+    ("startup-stats", "print how long it took to get to the first instruction on exit")
+    ("compile-only", "compile the file to its bytecode cache (foo.gh -> foo.ghc), without running it")
+    ("no-cache", "neither load nor save the bytecode cache")
+    ("snapshot", po::value<std::string>(), "start from the root environment saved in a snapshot, rather than an empty one (the bytecode cache isn't used with one)")
+    ("write-snapshot", po::value<std::string>(), "run the file, then save the root environment it leaves behind to a snapshot")
     ("file_name", po::value<std::string>()->required(), "path to the file to compile");
 
   po::variables_map vm;
@@ -54,6 +105,7 @@ CommandLineArguments& getArguments(int argc, char*argv[]) {
     po::store(po::command_line_parser(argc, argv)
               .options(desc)
               .positional(posixOptions)
+              .extra_parser(parseOptimizeFlag)
               .run()
               , vm);
 
@@ -63,6 +115,28 @@ CommandLineArguments& getArguments(int argc, char*argv[]) {
 
     args->ast = vm.count("ast") > 0;
     args->bytecode = vm.count("bytecode") > 0;
+    args->gcStats = vm.count("gc-stats") > 0;
+    args->startupStats = vm.count("startup-stats") > 0;
+    args->cache = vm.count("no-cache") == 0;
+    args->compileOnly = vm.count("compile-only") > 0;
+    if (vm.count("stack-size") > 0) {
+      args->stackSize = vm["stack-size"].as<int>();
+      if (args->stackSize <= 0) {
+        throw po::validation_error(po::validation_error::invalid_option_value,
+                                   "stack-size");
+      }
+    }
+    if (vm.count("optimize") > 0) {
+      args->optimizationLevel = vm["optimize"].as<int>();
+    }
+    if (vm.count("snapshot") > 0) {
+      args->snapshot = vm["snapshot"].as<std::string>();
+      // a cache is of a module compiled into an empty root.
+      args->cache = false;
+    }
+    if (vm.count("write-snapshot") > 0) {
+      args->writeSnapshot = vm["write-snapshot"].as<std::string>();
+    }
     return *args;
 
   } catch (po::error& e) {
@@ -73,6 +147,37 @@ CommandLineArguments& getArguments(int argc, char*argv[]) {
   }
 }
 
+void printGCStats() {
+  auto& stats = getGCStats();
+  std::cerr << "gc: " << stats.collections << " collections, "
+            << stats.objectsFreed << " objects freed, "
+            << stats.heapSize << " bytes in use" << std::endl;
+  std::cerr << "gc: pauses " << stats.totalPause << "us total, "
+            << stats.maxPause << "us max" << std::endl;
+}
+
+static long microsecondsBetween(GTime start, GTime end) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+void printStartupStats() {
+  auto& times = startupTimes;
+  if (times.firstInstruction == GTime()) {
+    std::cerr << "startup: nothing was run" << std::endl;
+    return;
+  }
+  std::cerr << "startup: " << microsecondsBetween(processStart, times.firstInstruction)
+            << "us to the first instruction" << std::endl;
+  std::cerr << "startup: " << microsecondsBetween(processStart, times.main)
+            << "us initializing statics, "
+            << microsecondsBetween(times.main, times.arguments)
+            << "us reading arguments, "
+            << microsecondsBetween(times.arguments, times.rootEnvironment)
+            << "us building the root environment, "
+            << microsecondsBetween(times.rootEnvironment, times.module)
+            << "us loading the module" << std::endl;
+}
+
 void dumpAST(PNode* node) {
   auto yaml = node->toYaml();
   std::cout << (*yaml) << std::endl;
@@ -81,7 +186,7 @@ void dumpAST(PNode* node) {
 // for debug purposes mainly
 void printValues() {
   for (auto symbol : globalScope->localsByName) {
-    auto name = symbol.first;
+    auto name = gstd::symbolName(symbol.first);
     auto object = globalScopeInstance->locals[symbol.second];
     auto type = globalScope->localsTypes[symbol.second];
     std::cout << name << ": ";
@@ -95,20 +200,15 @@ void printValues() {
       std::cout << "int32 " << object.asInt32;
     } else if (type == getStringType()) {
       std::cout << "string ";
-      auto str = object.asArray;
-      auto elements = str->elements;
-      for (int i = 0; i < str->size; i++) {
-        printf("%c", elements[i].asChar);
-      }
+      auto str = object.asString;
+      fwrite(str->bytes, 1, str->size, stdout);
     }
     std::cout << std::endl;
   }
 }
 
-GValue run(CommandLineArguments& args, std::istream& input_stream) {
-  debug("tokenizing...");
-  TokenVector tokens = tokenizer->tokenize(input_stream);
-  debug("tokenized!");
+// the code at the top level, or NULL if there's nothing to run.
+GBytecode* compile(CommandLineArguments& args, TokenVector& tokens) {
   Parser parser(tokens);
   debug("parsing block...!");
   auto pBlock = parser.parseBlock();
@@ -116,55 +216,113 @@ GValue run(CommandLineArguments& args, std::istream& input_stream) {
 
   if (args.ast) {
     dumpAST(pBlock);
-  } else {
-    int oldLocalsCount = globalScope->localsCount;
-    auto instructions = generateRoot(globalScope, pBlock);
-    debug("parsed.");
-
-    if (args.bytecode) {
-      for (auto type: globalScope->classes) {
-        std::cout << type->name << ":" << std::endl;
-
-        for (auto functionKV: type->environment->functionsByName) {
-          auto function = type->environment->functions[functionKV.second];
-          std::cout << functionKV.first << " (" << function << "):" << std::endl;
-          printInstructions(function->instructions);
-          std::cout << std::endl;
-        }
-      }
+    getCompilationArena().reset();
+    return NULL;
+  }
+  auto instructions = generateRoot(globalScope, pBlock);
+  debug("parsed.");
+  // the ast, and everything codegen needed to get from it to
+  // bytecode, goes at once.
+  getCompilationArena().reset();
+  return instructions;
+}
+
+GValue execute(CommandLineArguments& args, GBytecode* instructions) {
+  if (args.bytecode) {
+    for (auto type: globalScope->classes) {
+      std::cout << type->name << ":" << std::endl;
 
-      debug("printing bytecode.");
-      debug("functions count: " << globalScope->functionsCount);
-      for (auto functionKV: globalScope->functionsByName) {
-        debug(functionKV.second);
-        auto function = globalScope->functions[functionKV.second];
-        std::cout << functionKV.first << " (" << function << "):" << std::endl;
-        debug("functionByName: " << functionKV.first);
-        debug(function->instructions);
-        if (function->instructions != NULL) {
-          printInstructions(function->instructions);
-        }
+      for (auto functionKV: type->environment->functionsByName) {
+        auto function = type->environment->functions[functionKV.second];
+        std::cout << gstd::symbolName(functionKV.first) << " (" << function << "):" << std::endl;
+        printInstructions(function->instructions);
         std::cout << std::endl;
       }
-      std::cout << "main:" << std::endl;
-      printInstructions(instructions);
-      return {0};
-    } else {
-      debug("executing code.");
-      // for now, we build temp registers
-      auto registers = new GValue[globalScope->localsCount];
+    }
 
-      // copy values into new longer register array if necessary
-      for (int i = 0; i < oldLocalsCount; i++) {
-        registers[i] = globalScopeInstance->locals[i];
+    debug("printing bytecode.");
+    debug("functions count: " << globalScope->functionsCount);
+    for (auto functionKV: globalScope->functionsByName) {
+      debug(functionKV.second);
+      auto function = globalScope->functions[functionKV.second];
+      std::cout << gstd::symbolName(functionKV.first) << " (" << function << "):" << std::endl;
+      debug("functionByName: " << gstd::symbolName(functionKV.first));
+      debug(function->instructions);
+      if (function->instructions != NULL) {
+        printInstructions(function->instructions);
       }
+      std::cout << std::endl;
+    }
+    std::cout << "main:" << std::endl;
+    printInstructions(instructions);
+    return {0};
+  }
 
-      globalScopeInstance->locals = registers;
-      return executeInstructions(vm->modules, instructions, *globalScopeInstance);
+  debug("executing code.");
+  // the root frame sits at the bottom of the register stack, so
+  // it grows in place as new variables are declared.
+  auto registerStack = getRegisterStack();
+  int rootFrameSize = registerStack->top - globalScopeInstance->locals;
+  if (globalScope->localsCount > rootFrameSize) {
+    registerStack->push(globalScope->localsCount - rootFrameSize);
+  }
+  // names of the base environment become globals of the root as
+  // code refers to them, so they're resolved again each time.
+  delete[] globalScopeInstance->globals;
+  globalScopeInstance->globals =
+    globalScope->resolveGlobals(getBaseEnvironmentInstance());
+  if (startupTimes.firstInstruction == GTime()) {
+    startupTimes.firstInstruction = std::chrono::steady_clock::now();
+  }
+  return executeInstructions(vm->modules, instructions, *globalScopeInstance);
+}
+
+GValue run(CommandLineArguments& args, TokenVector& tokens) {
+  auto instructions = compile(args, tokens);
+  if (startupTimes.module == GTime()) {
+    startupTimes.module = std::chrono::steady_clock::now();
+  }
+  if (instructions == NULL) {
+    return {0};
+  }
+  return execute(args, instructions);
+}
+
+// runs a file, from its bytecode cache if it has one that's up to date.
+void runFile(CommandLineArguments& args) {
+  // files are scanned straight out of memory, rather than
+  // through a stream.
+  auto source = SourceBuffer::open(args.fileName);
+  auto cacheKey = getModuleCacheKey(source->begin, source->end - source->begin,
+                                    args.optimizationLevel);
+  auto cachePath = getModuleCachePath(args.fileName);
+
+  GBytecode* instructions = NULL;
+  if (args.cache && !args.ast) {
+    instructions = loadModuleCache(cachePath, cacheKey, globalScope);
+    debug("cache " << (instructions == NULL ? "miss" : "hit") << ": " << cachePath);
+  }
+  if (instructions == NULL) {
+    debug("tokenizing...");
+    TokenVector tokens = tokenizer->tokenize(*source);
+    debug("tokenized!");
+    instructions = compile(args, tokens);
+    // saved before it runs, as the execution engine links code in place.
+    if (instructions != NULL && args.cache &&
+        !writeModuleCache(cachePath, cacheKey, globalScope, instructions)) {
+      debug("unable to write " << cachePath);
     }
+  }
+  delete source;
+  startupTimes.module = std::chrono::steady_clock::now();
 
+  if (instructions != NULL && !args.compileOnly) {
+    execute(args, instructions);
+  }
+  if (args.writeSnapshot != "" &&
+      !writeSnapshot(args.writeSnapshot, *globalScopeInstance)) {
+    throw VMException("unable to write the snapshot " + args.writeSnapshot);
   }
-  return {0};
 }
 
 void interpreter(CommandLineArguments& args) {
@@ -178,35 +336,59 @@ void interpreter(CommandLineArguments& args) {
     }
     try {
       std::istringstream input_stream(input);
-      auto returnValue = run(args, input_stream);
+      TokenVector tokens = tokenizer->tokenize(input_stream);
+      run(args, tokens);
 
    } catch (LexerException& e) {
       std::cout << e.message << std::endl;
       continue;
     } catch (ParserException& e) {
       std::cout << e.message << std::endl;
+      getCompilationArena().reset();
+      continue;
+    } catch (VMException& e) {
+      std::cout << e.message << std::endl;
+      // drop whatever was left of the calls, back to the root frame.
+      getRegisterStack()->top = globalScopeInstance->locals + globalScope->localsCount;
       continue;
     }
   }
 }
 
+// the root environment, from a snapshot when there's one. otherwise
+// names of the base environment are brought into it as they're used,
+// so it starts out empty.
+void createRootEnvironment(CommandLineArguments& args) {
+  globalScope = new GEnvironment();
+  globalScope->parent = &getBaseEnvironment();
+  globalScopeInstance = new GEnvironmentInstance { .environment = globalScope };
+  if (args.snapshot != "") {
+    if (!loadSnapshot(args.snapshot, *globalScopeInstance)) {
+      throw VMException("unable to load the snapshot " + args.snapshot);
+    }
+    return;
+  }
+  globalScopeInstance->globals =
+    globalScope->resolveGlobals(getBaseEnvironmentInstance());
+  globalScopeInstance->locals = getRegisterStack()->push(globalScope->localsCount);
+}
+
 int main(int argc, char *argv[]) {
+  startupTimes.main = std::chrono::steady_clock::now();
   tokenizer = new Tokenizer();
-  // convoluted way to get a child environment.
-  auto scope = new codegen::GScope();
-  scope->environment = &getBaseEnvironment();
-  globalScope = scope->createChild(true)->environment;
-
-  globalScopeInstance = \
-    globalScope->createInstance(getBaseEnvironmentInstance());
+  CommandLineArguments& args = getArguments(argc, argv);
+  setRegisterStackSize((size_t) args.stackSize * 1024 * 1024 / sizeof(GValue));
+  codegen::setOptimizationLevel(args.optimizationLevel);
   vm = new GVM();
   vm->modules = new GModules();
-  CommandLineArguments& args = getArguments(argc, argv);
+  startupTimes.arguments = std::chrono::steady_clock::now();
 
   try {
+    createRootEnvironment(args);
+    startupTimes.rootEnvironment = std::chrono::steady_clock::now();
+
     if (args.fileName != "") {
-      std::ifstream input_stream(args.fileName);
-      run(args, input_stream);
+      runFile(args);
 
     } else {
       interpreter(args);
@@ -222,6 +404,18 @@ int main(int argc, char *argv[]) {
       std::cout << e.specMessage << std::endl;
     }
     exit(1);
+  } catch (VM::VMException& e) {
+    std::cout << e.message << std::endl;
+    exit(1);
+  } catch (lexer::SourceException& e) {
+    std::cout << e.message << std::endl;
+    exit(1);
+  }
+  if (args.gcStats) {
+    printGCStats();
+  }
+  if (args.startupStats) {
+    printStartupStats();
   }
   return 0;
 }
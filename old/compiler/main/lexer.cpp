@@ -1,8 +1,12 @@
 /*
    This generates the 'lexer' executable under 'bin'.
    It brings up a prompt that will read in a string and return a proper set of tokens
+
+   lexer --benchmark <file> tokenizes the file a few times, and reports
+   how many tokens a second the fastest run managed.
  */
 #include "../lexer/tokenizer.hpp"
+#include <chrono>
 #include <sstream>
 #include <fstream>
 
@@ -12,14 +16,46 @@ using namespace lexer;
 void parseTokens(TokenVector& tokens) {
   cout << tokens.size() << " tokens found." << endl;
   for (TokenVector::const_iterator it = tokens.begin(); it != tokens.end(); ++it) {
-    cout << (*it)->getFullDescription() << endl;
+    cout << it->getFullDescription() << endl;
+  }
+}
+
+const int BENCHMARK_RUNS = 5;
+
+int benchmark(string filename) {
+  Tokenizer tokenizer;
+  double best = 0;
+  size_t count = 0;
+  try {
+    auto source = SourceBuffer::open(filename);
+    for (int i = 0; i < BENCHMARK_RUNS; i++) {
+      auto start = chrono::steady_clock::now();
+      TokenVector tokens = tokenizer.tokenize(*source);
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      if (i == 0 || elapsed.count() < best) {
+        best = elapsed.count();
+      }
+      count = tokens.size();
+    }
+    delete source;
+  } catch (SourceException& e) {
+    cout << e.message << endl;
+    return 1;
+  } catch (LexerException& e) {
+    cout << e.message << endl;
+    return 1;
   }
+  cout << count << " tokens in " << best << "s, "
+       << (long) (count / best) << " tokens/s" << endl;
+  return 0;
 }
 
 int main(int argc, char* argv[]) {
   string input;
   Tokenizer tokenizer;
-  if (argc == 2) {
+  if (argc == 3 && string(argv[1]) == "--benchmark") {
+    return benchmark(argv[2]);
+  } else if (argc == 2) {
     string filename(argv[1]);
     ifstream input_stream(filename);
     try {
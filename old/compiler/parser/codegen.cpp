@@ -1,5 +1,6 @@
 #include "nodes.hpp"
 #include "exceptions.hpp"
+#include "../codegen/passes.hpp"
 #include <iostream>
 #include <typeinfo>
 
@@ -48,8 +49,9 @@ namespace parser {
   }
 
   // determine if the identifier is a type
-  bool isType(std::string identifier) {
-    return identifier[0] >= 'A' && identifier[0] <= 'Z';
+  bool isType(gstd::Symbol identifier) {
+    auto& name = gstd::symbolName(identifier);
+    return name[0] >= 'A' && name[0] <= 'Z';
   }
 
   GType* evaluateType(std::string typeName) {
@@ -66,31 +68,34 @@ namespace parser {
     throw ParserException("Cannot find class " + typeName);
   }
 
-  GInstruction* generateRoot(VM::GEnvironment* environment, PBlock* block) {
+  GBytecode* generateRoot(VM::GEnvironment* environment, PBlock* block) {
+    environment->isModule = true;
     auto scope = new GScope { .environment = environment };
-    auto instructions = block->generate(scope);
+    GInstructionVector instructions;
+    block->generate(scope, instructions);
 
-    instructions->push_back(GInstruction { END, NULL });
-    return &(*instructions)[0];
+    instructions.push_back(GInstruction { END, NULL });
+    return finalizeInstructions(environment, instructions);
   }
 
-  GInstructionVector* PBlock::generate(GScope* scope) {
+  // blocks are generated into the instructions of the body they're
+  // in, rather than instructions of their own.
+  void PBlock::generate(GScope* scope, GInstructionVector& instructions) {
     debug("PARSER: Generating Block")
-    auto instructions = new GInstructionVector;
     for (auto statement : statements) {
       debug("  generating statement...")
-      statement->generateStatement(scope, *instructions);
+      statement->generateStatement(scope, instructions);
     }
     debug("  finalizing...");
     scope->finalize();
     debug("  finished finalizing...");
-    return instructions;
   }
 
   GIndex* PCall::generateExpression(GScope* scope,
                                      GInstructionVector& instructions) {
     debug("  calling method");
-    if (name == "print") {
+    static const gstd::Symbol print = gstd::intern("print");
+    if (name == print) {
 
       debug("    adding print.");
       auto argument = arguments[0]->generateExpression(scope, instructions);
@@ -121,14 +126,20 @@ namespace parser {
           op, new GOPARG[1] { { argument->registerNum } }
       });
 
-    } else if (auto functionIndex = scope->getObject(name)) {
-      functionIndex = enforceLocal(scope, functionIndex, instructions);
+    } else if (scope->getSelf() != NULL &&
+               scope->getSelf()->type->environment->getFunction(name) != NULL) {
+      // another method of the same instance.
+      auto self = scope->getSelf();
+      return generateMethodCall(scope, instructions, self,
+                                self->type->environment->getFunction(name),
+                                arguments);
 
+    } else if (auto functionIndex = scope->getObject(name)) {
       GOPCODE instruction;
       GType* returnType;
 
       debug("    getting type values");
-      debug(name)
+      debug(gstd::symbolName(name))
       if (isType(name)) {
         instruction = INSTANCE_CREATE;
         returnType = scope->getClass(name);
@@ -137,7 +148,7 @@ namespace parser {
         returnType = scope->getFunction(name)->returnType;
       }
       if (functionIndex->type != getFunctionType() && functionIndex->type != getClassType()) {
-        throw ParserException("" + name + " is not a Function or Class! found " + functionIndex->type->name);
+        throw ParserException(gstd::symbolName(name) + " is not a Function or Class! found " + functionIndex->type->name);
       }
 
       auto opArgs = new std::vector<GOPARG>;
@@ -147,13 +158,25 @@ namespace parser {
       auto returnObject = scope->allocateObject(returnType);
       opArgs->push_back(GOPARG{ returnObject->registerNum });
 
-      // second OPARG is the function pointer
-      opArgs->push_back(GOPARG{ .registerNum = functionIndex->registerNum });
+      // second OPARG is the function pointer. functions that are
+      // known when compiling are called directly, without loading
+      // the function object.
+      if (instruction == FUNCTION_CALL && scope->getFunction(name)->isStatic) {
+        instruction = CALL_DIRECT;
+        opArgs->push_back(GOPARG{ .constantIndex = scope->environment->addConstant(
+          GValue { .asRawFunction = scope->getFunction(name) }) });
+      } else {
+        functionIndex = enforceLocal(scope, functionIndex, instructions);
+        opArgs->push_back(GOPARG{ .registerNum = functionIndex->registerNum });
+      }
+
+      // third OPARG is the argument count
+      opArgs->push_back(GOPARG{ .size = (int) arguments.size() });
 
       debug("allocating arguments");
-      // third on are the actual arguments
+      // fourth on are the actual arguments
       for (auto argument : arguments) {
-        auto object = argument->generateExpression(scope, instructions);
+        auto object = argument->generateBoundExpression(scope, instructions);
         object = enforceLocal(scope, object, instructions);
         opArgs->push_back(GOPARG { object->registerNum });
       }
@@ -165,7 +188,7 @@ namespace parser {
       instructions.push_back(GInstruction { instruction, &(*opArgs)[0] });
       return returnObject;
     } else {
-      throw ParserException("Unable to call method " + name);
+      throw ParserException("Unable to call method " + gstd::symbolName(name));
     }
     debug("returning null on function call")
     return NULL;
@@ -175,7 +198,8 @@ namespace parser {
                        PArrayAccess* arrayAccess, GIndex* value) {
     auto array = arrayAccess->value->generateExpression(scope, instructions);
     auto index = arrayAccess->index->generateExpression(scope, instructions);
-    instructions.push_back(GInstruction { ARRAY_SET_VALUE, new GOPARG[3] {
+    auto op = isStringType(array->type) ? STRING_SET_CHAR : ARRAY_SET_VALUE;
+    instructions.push_back(GInstruction { op, new GOPARG[3] {
           {array->registerNum}, {index->registerNum}, {value->registerNum}
     }});
   }
@@ -183,7 +207,7 @@ namespace parser {
   void PAssign::generateStatement(GScope* scope,
                                   GInstructionVector& instructions) {
     // if the value is an array, we set it differently
-    auto value = expression->generateExpression(scope, instructions);
+    auto value = expression->generateBoundExpression(scope, instructions);
 
     if (auto arrayAccess = dynamic_cast<PArrayAccess*>(identifier)) {
       setArrayElement(scope, instructions, arrayAccess, value);
@@ -371,7 +395,8 @@ namespace parser {
 
   void PReturn::generateStatement(GScope* scope,
                                   GInstructionVector& instructions) {
-    auto returnObject = expression->generateExpression(scope, instructions);
+    auto returnObject = expression->generateBoundExpression(scope, instructions);
+    returnObject = enforceLocal(scope, returnObject, instructions);
     instructions.push_back(GInstruction {
         GOPCODE::RETURN, new GOPARG[1] { { returnObject->registerNum }}
     });
@@ -379,9 +404,22 @@ namespace parser {
 
   GIndex* PConstantString::generateExpression(GScope* s, GInstructionVector& i) {
     auto target = s->allocateObject(getStringType());
+    auto constantIndex = s->environment->addConstant(GValue { .asString = internString(value) });
     i.push_back(GInstruction {
         GOPCODE::LOAD_CONSTANT_STRING, new VM::GOPARG[2] {
-          { target->registerNum }, GOPARG { .asString = value.c_str() }
+          { target->registerNum }, { constantIndex }
+        }});
+    return target;
+  }
+
+  // literals are shared by every use of them, so a literal that's
+  // bound somewhere is copied first, as if it was created there.
+  GIndex* PConstantString::generateBoundExpression(GScope* s, GInstructionVector& i) {
+    auto literal = generateExpression(s, i);
+    auto target = s->allocateObject(getStringType());
+    i.push_back(GInstruction {
+        GOPCODE::STRING_COPY, new VM::GOPARG[2] {
+          { literal->registerNum }, { target->registerNum }
         }});
     return target;
   }
@@ -394,25 +432,25 @@ namespace parser {
     while (debugScope != NULL) {
       debug("  locals:");
       for (auto& kv: debugScope->localsByName) {
-        debug("    " << kv.first << ": " << kv.second);
+        debug("    " << gstd::symbolName(kv.first) << ": " << kv.second);
       }
       debugScope = debugScope->parentScope;
     }
 
     debug("  environment locals:");
     for (auto& kv: scope->environment->localsByName) {
-      debug("    " << kv.first << ": " << kv.second);
+      debug("    " << gstd::symbolName(kv.first) << ": " << kv.second);
     }
 
     debug("  environment globals:");
     for (auto& kv: scope->environment->globalsByName) {
-      debug("    " << kv.first << ": " << kv.second);
+      debug("    " << gstd::symbolName(kv.first) << ": " << kv.second);
     }
 
     auto object = scope->getObject(name);
 
     if (object == NULL) {
-      throw ParserException("Object " + name + " is not defined in this scope!");
+      throw ParserException("Object " + gstd::symbolName(name) + " is not defined in this scope!");
     }
     return object;
   }
@@ -420,16 +458,15 @@ namespace parser {
   void PForLoop::generateStatement(GScope* scope,
                                    GInstructionVector& instructions) {
     initializer->generateStatement(scope, instructions);
-    auto statements = body->generate(scope);
-    auto forLoopStart = instructions.size();
-    instructions.reserve(instructions.size() + distance(statements->begin(), statements->end()));
-    instructions.insert(instructions.end(), statements->begin(), statements->end());
+    GLabel loopStart;
+    loopStart.bind(instructions);
+    body->generate(scope, instructions);
     incrementer->generateStatement(scope, instructions);
     auto conditionObject = condition->generateExpression(scope, instructions);
     instructions.push_back(GInstruction {
-        GOPCODE::BRANCH,
-          new GOPARG[3] { conditionObject->registerNum, (int) forLoopStart - ((int) instructions.size()), 1 }
+        GOPCODE::BRANCH, new GOPARG[3] { conditionObject->registerNum, 0, 1 }
       });
+    loopStart.addJump(instructions, 1);
   }
 
   void PFunctionDeclaration::generateStatement(GScope* scope,
@@ -437,14 +474,15 @@ namespace parser {
     debug("PFunctionDeclaration");
 
     if (scope->getObject(name) != NULL) {
-      throw ParserException("Cannot redeclare " + name);
+      throw ParserException("Cannot redeclare " + gstd::symbolName(name));
     }
 
     auto index = scope->addFunction(name, new GFunction {
         .argumentCount = (int) arguments.size(),
         .returnType = returnType->generateType(scope),
+        .isStatic = scope->environment->isModule,
     }, this);
-    debug("PFunctionDeclaration name: " << name);
+    debug("PFunctionDeclaration name: " << gstd::symbolName(name));
     auto functionIndex = scope->functionsByName[name];
     debug("PFunctionDeclaration index: " << functionIndex);
 
@@ -454,7 +492,8 @@ namespace parser {
         }});
   }
 
-  void PFunctionDeclaration::generateBody(GFunction* function, GScope* scope) {
+  void PFunctionDeclaration::generateBody(GFunction* function, GScope* scope,
+                                          GType* classType) {
     debug("generating function body");
     GScope* functionScope = scope->createChild(true);
 
@@ -462,6 +501,21 @@ namespace parser {
     function->argumentTypes = new GType*[arguments.size()];
     function->environment = functionScope->environment;
 
+    // methods are passed their instance first, and refer to its
+    // attributes through it.
+    if (classType != NULL) {
+      functionScope->self = functionScope->environment->allocateVariable(classType);
+      auto classEnvironment = classType->environment;
+      for (auto& kv: classEnvironment->localsByName) {
+        functionScope->localsByName[kv.first] = new GIndex {
+          .indexType = OBJECT_PROPERTY,
+          .objectIndex = functionScope->self,
+          .registerNum = kv.second,
+          .type = classEnvironment->localsTypes[kv.second]
+        };
+      }
+    }
+
 
     int i = 0;
     for (auto argument : arguments) {
@@ -469,28 +523,30 @@ namespace parser {
       auto type = evaluateType(argument->second);
 
       functionScope->addObject(argument->first, type);
-      function->argumentNames[i] = argument->first;
+      function->argumentNames[i] = gstd::symbolName(argument->first);
       function->argumentTypes[i] = type;
       i++;
     }
 
-    auto vmBody = body->generate(functionScope);
-    vmBody->push_back(GInstruction { END, 0 });
-    function->instructions = &(*vmBody)[0];
+    GInstructionVector vmBody;
+    body->generate(functionScope, vmBody);
+    vmBody.push_back(GInstruction { END, 0 });
+    function->instructions = finalizeInstructions(functionScope->environment,
+                                                  vmBody);
     debug("function instructions: " << function->instructions);
     debug("function: " << function);
   }
 
   void PClassDeclaration::generateStatement(GScope* scope,
                                             GInstructionVector& instr) {
-    debug("  creating class " + name);
+    debug("  creating class " + gstd::symbolName(name));
     debug(scope);
     debug(scope->environment);
     auto classScope = scope->createChild(true);
     debug ("    finished creating child.")
 
     for (auto& kv: attributes) {
-      classScope->addObject(kv.first, evaluateType(kv.second));
+      classScope->addObject(gstd::intern(kv.first), evaluateType(kv.second));
     }
 
     debug("    creating class attributes")
@@ -503,26 +559,29 @@ namespace parser {
         .returnType = method->returnType->generateType(scope)
       };
       createdFunctions[i] = function;
-      debug("    adding function " + method->name + "...")
-      classScope->addFunction(method->name, function, method);
+      debug("    adding function " + gstd::symbolName(method->name) + "...")
+      // methods are found through the class, so unlike functions
+      // they don't take up a register in every instance.
+      auto functionIndex = classScope->environment->allocateFunction(function);
+      classScope->environment->functionsByName[method->name] = functionIndex;
     }
 
+    auto type = new GType {
+      .name = gstd::symbolName(name),
+      .subTypes = gstd::Array<GType*>(0),
+      .attributeCount = (int) attributes.size(),
+      .functionCount = (int) methods.size(),
+      .environment = classScope->environment
+    };
+
     // we generate the bodies at the end, to ensure that all
     // class functions are available to all other methods.
     for (int i = 0; i < (int) methods.size(); i++) {
       auto method = methods[i];
       auto function = createdFunctions[i];
-      method->generateBody(function, classScope);
+      method->generateBody(function, scope, type);
     }
 
-    auto type = new GType {
-      .name = name,
-      .subTypes = gstd::Array<GType*>(0),
-      .attributeCount = (int) attributes.size(),
-      .environment = classScope->environment,
-      .functionCount = (int) methods.size()
-    };
-
     auto classIndex = scope->addClass(name, type);
     auto classInLocalsIndex = scope->addObject(name, getClassType());
     instr.push_back(GInstruction {
@@ -537,41 +596,28 @@ namespace parser {
     debug("PIfElse");
     auto conditionObject = condition->generateExpression(scope, instructions);
 
-    auto trueScope = scope->createChild(false);
-    auto trueInstructions = trueBlock->generate(trueScope);
-
+    GLabel falseStart;
     instructions.push_back(GInstruction { GOPCODE::BRANCH, new GOPARG[3] {
-          { conditionObject->registerNum },
-          { 1 },
-          // go up by two: one to iterate passed the last instruction
-          // one to increment passed the GO op
-          { (int) trueInstructions->size() + 2 }}
+          { conditionObject->registerNum }, { 1 }, { 0 }}
     });
+    falseStart.addJump(instructions, 2);
 
-    instructions.reserve(instructions.size()
-                         + distance(trueInstructions->begin(),
-                                    trueInstructions->end()));
-    instructions.insert(instructions.end(),
-                        trueInstructions->begin(),
-                        trueInstructions->end());
+    auto trueScope = scope->createChild(false);
+    trueBlock->generate(trueScope, instructions);
 
     if (falseBlock == NULL) {
+      falseStart.bind(instructions);
       return;
     }
 
-    auto falseScope = scope->createChild(false);
-    auto falseInstructions = falseBlock->generate(falseScope);
-
-    instructions.push_back(GInstruction { GOPCODE::GO, new GOPARG[1] {
-          { (int) falseInstructions->size() + 1 }
-    }});
+    GLabel end;
+    instructions.push_back(GInstruction { GOPCODE::GO, new GOPARG[1] { 0 }});
+    end.addJump(instructions, 0);
 
-    instructions.reserve(instructions.size()
-                         + distance(falseInstructions->begin(),
-                                    falseInstructions->end()));
-    instructions.insert(instructions.end(),
-                        falseInstructions->begin(),
-                        falseInstructions->end());
+    falseStart.bind(instructions);
+    auto falseScope = scope->createChild(false);
+    falseBlock->generate(falseScope, instructions);
+    end.bind(instructions);
   }
 
   GIndex* PConstantArray::generateExpression(GScope* scope,
@@ -583,13 +629,18 @@ namespace parser {
 
     auto arrayObject = scope->allocateObject(getNoneType());
     auto type = getNoneType();
+    // the type isn't known until the elements are, so it's filled in
+    // at the end.
+    auto typeConstant = scope->environment->addConstant(GValue { .asType = NULL });
     instructions.push_back(GInstruction {
-        ARRAY_ALLOCATE, new GOPARG[2] { arrayObject->registerNum, sizeObject->registerNum }
+        ARRAY_ALLOCATE, new GOPARG[3] {
+          arrayObject->registerNum, sizeObject->registerNum, { .constantIndex = typeConstant }
+        }
     });
     auto indexObject = scope->allocateObject(getInt32Type());
 
     for (int i = 0; i < elements.size(); i++) {
-      auto element = elements[i]->generateExpression(scope, instructions);
+      auto element = elements[i]->generateBoundExpression(scope, instructions);
 
       instructions.push_back(GInstruction {
           LOAD_CONSTANT_INT, new GOPARG[2] { indexObject->registerNum, i }
@@ -602,6 +653,8 @@ namespace parser {
       type = element->type;
     }
     arrayObject->type = getArrayType(type);
+    scope->environment->localsTypes[arrayObject->registerNum] = arrayObject->type;
+    scope->environment->constants[typeConstant].asType = arrayObject->type;
     return arrayObject;
   }
 
@@ -616,7 +669,8 @@ namespace parser {
       throw ParserException("index on array is not an int");
     }
     instructions.push_back(GInstruction {
-        GOPCODE::ARRAY_LOAD_VALUE, new GOPARG[3] {
+        isStringType(valueObject->type) ? STRING_LOAD_CHAR : ARRAY_LOAD_VALUE,
+        new GOPARG[3] {
           valueObject->registerNum,
           indexObject->registerNum,
           objectRegister->registerNum
@@ -636,7 +690,7 @@ namespace parser {
     auto attribute = objectType->environment->getObject(propertyName);
 
     if (attribute == NULL) {
-      throw ParserException("unable to retrieve type for property " + propertyName);
+      throw ParserException("unable to retrieve type for property " + gstd::symbolName(propertyName));
     }
 
     return new GIndex {
@@ -648,8 +702,10 @@ namespace parser {
   }
 
   // generates the instructions to parse the array
-  void parseArrayIterator(std::string varName, GIndex* array, PBlock* body,
+  void parseArrayIterator(gstd::Symbol varName, GIndex* array, PBlock* body,
                           GScope* scope, GInstructionVector& instructions) {
+    // strings are iterated over char by char, like an array.
+    bool isString = isStringType(array->type);
     GScope* forScope = scope->createChild(false);
     auto iteratorIndex = scope->allocateObject(getInt32Type());
     instructions.push_back(GInstruction {
@@ -670,26 +726,25 @@ namespace parser {
 
     auto arraySize = scope->allocateObject(getInt32Type());
     instructions.push_back(GInstruction {
-        ARRAY_LOAD_LENGTH, new GOPARG[2] { array->registerNum, arraySize->registerNum }
+        isString ? STRING_LOAD_LENGTH : ARRAY_LOAD_LENGTH,
+        new GOPARG[2] { array->registerNum, arraySize->registerNum }
     });
 
     auto conditionObject = scope->allocateObject(getBoolType());
 
     // initialize statement
 
-    auto forLoopStart = instructions.size();
+    GLabel loopStart;
+    loopStart.bind(instructions);
     instructions.push_back(GInstruction {
-        ARRAY_LOAD_VALUE, new GOPARG[3] {
+        isString ? STRING_LOAD_CHAR : ARRAY_LOAD_VALUE, new GOPARG[3] {
           array->registerNum,
           iteratorIndex->registerNum,
           iteratorObject->registerNum
         }
     });
 
-    auto statements = body->generate(forScope);
-    instructions.reserve(instructions.size()
-                         + distance(statements->begin(), statements->end()));
-    instructions.insert(instructions.end(), statements->begin(), statements->end());
+    body->generate(forScope, instructions);
 
     instructions.push_back(GInstruction {
         GOPCODE::ADD_INT, new GOPARG[3] {
@@ -706,18 +761,17 @@ namespace parser {
 
     instructions.push_back(GInstruction {
         BRANCH, new GOPARG[3] {
-          conditionObject->registerNum,
-          (int) forLoopStart - (int) instructions.size(),
-          { 1 }
+          conditionObject->registerNum, { 0 }, { 1 }
         }
     });
+    loopStart.addJump(instructions, 1);
   }
 
   void PForeachLoop::generateStatement(GScope* scope,
                                        GInstructionVector& instructions) {
     auto iterableValue = iterableExpression->generateExpression(scope, instructions);
     // if the value is an array, we iterate through the array first
-    if (isArrayType(iterableValue->type)) {
+    if (isArrayType(iterableValue->type) || isStringType(iterableValue->type)) {
       parseArrayIterator(variableName, iterableValue, block,
                          scope, instructions);
     } else {
@@ -13,8 +13,13 @@ namespace parser {
     return node;
   }
 
-  GType* PArray::getType(codegen::GScope* scope) {
-    return getArrayType(type->generateType(scope));
+  // an array of chars is a string.
+  GType* PArray::computeType(codegen::GScope* scope) {
+    auto elementType = type->generateType(scope);
+    if (elementType == getCharType()) {
+      return getStringType();
+    }
+    return getArrayType(elementType);
   }
 
   GIndex* PArray::generateExpression(codegen::GScope* scope,
@@ -30,9 +35,18 @@ namespace parser {
     auto arrayType = getType(scope);
     auto arrayObject = scope->allocateObject(arrayType);
 
-    instr.push_back(GInstruction {
-        ARRAY_ALLOCATE, new GOPARG[2] {
-          arrayObject->registerNum, sizeObject->registerNum
+    if (isStringType(arrayType)) {
+      instr.push_back(GInstruction { STRING_ALLOCATE, new GOPARG[2] {
+            arrayObject->registerNum, sizeObject->registerNum
+      }});
+      return arrayObject;
+    }
+
+    // the array is allocated with its type, so the collector knows
+    // what its elements are.
+    auto typeConstant = scope->environment->addConstant(GValue { .asType = arrayType });
+    instr.push_back(GInstruction { ARRAY_ALLOCATE, new GOPARG[3] {
+          arrayObject->registerNum, sizeObject->registerNum, { .constantIndex = typeConstant }
     }});
     return arrayObject;
   }
@@ -16,7 +16,7 @@ namespace parser {
   YAML::Node* PDeclare::toYaml() {
     auto root = new YAML::Node();
     for (int i = 0; i < names.length(); i++) {
-      (*root)["declare"]["names"].push_back(names[i]);
+      (*root)["declare"]["names"].push_back(gstd::symbolName(names[i]));
     }
     (*root)["declare"]["value"] = *expression->toYaml();
     return root;
@@ -25,7 +25,7 @@ namespace parser {
   void PDeclare::generateStatement(GScope* scope,
                                    GInstructionVector& instr) {
     debug("  declaring...")
-    auto value = expression->generateExpression(scope, instr);
+    auto value = expression->generateBoundExpression(scope, instr);
     if (names.length() == 1) {
       // handle the singular case
       auto newVar = scope->addObject(names[0], value->type);
@@ -5,7 +5,7 @@ using namespace codegen;
 
 namespace parser {
 
-  GType* PIdentifier::getType(codegen::GScope* scope) {
+  GType* PIdentifier::computeType(codegen::GScope* scope) {
     auto object = scope->getObject(name);
     return object != NULL ? object->type : VM::getNoneType();
   }
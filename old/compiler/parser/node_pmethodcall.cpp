@@ -6,7 +6,7 @@ using namespace codegen;
 
 namespace parser {
 
-  PrimitiveMethod getPrimitiveMethod(GType* type, std::string methodName) {
+  PrimitiveMethod getPrimitiveMethod(GType* type, const std::string& methodName) {
     auto typeName = type->name.c_str();
     if (primitives.find(typeName) == primitives.end()) {
       throw ParserException("unable to find primitive method dict for " + type->name);
@@ -18,18 +18,50 @@ namespace parser {
     return primitives[typeName][methodName.c_str()];
   }
 
-  GType* PMethodCall::getType(GScope* scope) {
+  // primitive methods with an instruction of their own, or END if
+  // there isn't one.
+  static GOPCODE getPrimitiveOp(GType* type, gstd::Symbol methodName) {
+    static const gstd::Symbol size = gstd::intern("size");
+    if (methodName == size) {
+      if (isArrayType(type)) { return ARRAY_LOAD_LENGTH; }
+      if (isStringType(type)) { return STRING_LOAD_LENGTH; }
+    }
+    return END;
+  }
+
+  static void checkArguments(GScope* scope, GFunction* function,
+                             PExpressions& arguments) {
+    if (function->argumentCount != (int) arguments.size()) {
+      throw ParserException("Argument count mismatch! " +
+                            std::to_string(function->argumentCount) +
+                            " values passed, " +
+                            std::to_string((int) arguments.size()) +
+                            " expected.");
+    }
+
+    for (int i = 0; i < function->argumentCount; i++) {
+      GType* expectedType = function->argumentTypes[i];
+      GType* actualType = arguments[i]->getType(scope);
+      if (expectedType != actualType) {
+        throw ParserException("Argument types mismatch! "
+                              "expected " + expectedType->name +
+                              ", found " + actualType->name);
+      }
+    }
+  }
+
+  GType* PMethodCall::computeType(GScope* scope) {
     auto objectType = currentValue->getType(scope);
     if (objectType == getBuiltinModuleType()) {
       return getNoneType();
     } else if (objectType->isPrimitive) {
-      auto primitiveMethod = getPrimitiveMethod(objectType, methodName);
+      auto primitiveMethod = getPrimitiveMethod(objectType, gstd::symbolName(methodName));
       return primitiveMethod.returnType;
     } else {
       auto function = objectType->environment->getFunction(methodName);
       if (function == NULL) {
         throw ParserException("Unable to find method " +
-                              methodName + " in class " +
+                              gstd::symbolName(methodName) + " in class " +
                               objectType->name);
       }
       return function->returnType;
@@ -43,65 +75,87 @@ namespace parser {
     object = enforceLocal(scope, object, instr);
 
     if (object->type->isPrimitive) {
-      auto primitiveMethod = getPrimitiveMethod(object->type, methodName);
+      auto primitiveMethod = getPrimitiveMethod(object->type, gstd::symbolName(methodName));
       auto returnObject = scope->allocateObject(primitiveMethod.returnType);
-      instr.push_back(GInstruction { GOPCODE::PRIMITIVE_METHOD_CALL, new GOPARG[4] {
+      auto op = getPrimitiveOp(object->type, methodName);
+      if (op != END) {
+        instr.push_back(GInstruction { op, new GOPARG[2] {
+              {object->registerNum}, {returnObject->registerNum}
+        }});
+        return returnObject;
+      }
+
+      // the method is looked up now, rather than every time it's called.
+      auto method = scope->environment->addConstant(GValue {
+          .asPrimitiveMethod = primitiveMethod.rawMethod
+      });
+      instr.push_back(GInstruction { GOPCODE::PRIMITIVE_METHOD_CALL, new GOPARG[3] {
             {returnObject->registerNum},
             {object->registerNum},
-            {.asString = object->type->name.c_str()},
-            {.asString = methodName.c_str()},
+            {.constantIndex = method},
       }});
       return returnObject;
     }
 
-    auto funcRegister = scope->allocateObject(getFunctionType());
     auto type = object->type;
+    auto function = type->environment->getFunction(methodName);
+    if (function == NULL) {
+      throw ParserException("Unable to find method " +
+                            gstd::symbolName(methodName) + " in class " + type->name);
+    }
+    if (!function->isNative) {
+      return generateMethodCall(scope, instr, object, function, arguments);
+    }
+
     auto methodIdx = type->environment->getObject(methodName);
+    auto funcRegister = scope->allocateObject(getBuiltinType());
     instr.push_back(GInstruction {
         GOPCODE::INSTANCE_LOAD_ATTRIBUTE, new GOPARG[3] {
           funcRegister->registerNum, object->registerNum, methodIdx->registerNum
         }
     });
 
-    GOPCODE instruction;
-    GIndex* returnValue;
-    auto argumentRegisters = new GOPARG[2 + arguments.size()];
-    auto function = type->environment->getFunction(methodName);
-    if (function->isNative) {
-      instruction = GOPCODE::BUILTIN_CALL;
-    } else {
-      instruction = GOPCODE::FUNCTION_CALL;
-    }
+    checkArguments(scope, function, arguments);
 
-    if (function->argumentCount != (int) arguments.size()) {
-      throw ParserException("Argument count mismatch! " +
-                            std::to_string(function->argumentCount) +
-                            " values passed, " +
-                            std::to_string((int) arguments.size()) +
-                            " expected.");
+    auto returnValue = scope->allocateObject(function->returnType);
+    auto argumentRegisters = new GOPARG[3 + arguments.size()];
+    argumentRegisters[0].registerNum = returnValue->registerNum;
+    argumentRegisters[1].registerNum = funcRegister->registerNum;
+    argumentRegisters[2].size = (int) arguments.size();
+    for (int i = 0; i < (int) arguments.size(); i++) {
+      auto index = arguments[i]->generateBoundExpression(scope, instr);
+      index = enforceLocal(scope, index, instr);
+      argumentRegisters[i + 3].registerNum = index->registerNum;
     }
 
-    for (int i = 0; i < function->argumentCount; i++) {
-      GType* expectedType = function->argumentTypes[i];
-      GType* actualType = arguments[i]->getType(scope);
-      if (expectedType != actualType) {
-        throw ParserException("Argument types mismatch! "
-                              "expected " + expectedType->name +
-                              ", found " + actualType->name);
-      }
-    }
+    instr.push_back(GInstruction {
+        GOPCODE::BUILTIN_CALL, argumentRegisters
+    });
+    return returnValue;
+  }
+
+  // methods are known once the class of object is, so they're called
+  // directly, with object passed along with the arguments.
+  GIndex* generateMethodCall(GScope* scope, GInstructionVector& instr,
+                             GIndex* object, GFunction* method,
+                             PExpressions& arguments) {
+    checkArguments(scope, method, arguments);
 
-    returnValue = scope->allocateObject(function->returnType);
+    auto returnValue = scope->allocateObject(method->returnType);
+    auto argumentRegisters = new GOPARG[4 + arguments.size()];
     argumentRegisters[0].registerNum = returnValue->registerNum;
-    argumentRegisters[1].registerNum = funcRegister->registerNum;
+    argumentRegisters[1].registerNum = object->registerNum;
+    argumentRegisters[2].constantIndex = scope->environment->addConstant(
+      GValue { .asRawFunction = method });
+    argumentRegisters[3].size = (int) arguments.size();
     for (int i = 0; i < (int) arguments.size(); i++) {
-      auto index = arguments[i]->generateExpression(scope, instr);
+      auto index = arguments[i]->generateBoundExpression(scope, instr);
       index = enforceLocal(scope, index, instr);
-      argumentRegisters[i + 2].registerNum = index->registerNum;
+      argumentRegisters[i + 4].registerNum = index->registerNum;
     }
 
     instr.push_back(GInstruction {
-        instruction, argumentRegisters
+        GOPCODE::CALL_METHOD_DIRECT, argumentRegisters
     });
     return returnValue;
   }
@@ -16,7 +16,7 @@ namespace parser {
     return root;
   }
 
-  GType* PTuple::getType(GScope* scope) {
+  GType* PTuple::computeType(GScope* scope) {
     Array<GType*> types(values.size());
     for (int i = 0; i < types.length(); i++) {
       types[i] = values[i]->getType(scope);
@@ -31,12 +31,13 @@ namespace parser {
           { size->registerNum } , { (int) values.size() }
     }});
     auto tuple = scope->allocateObject(getType(scope));
-    instr.push_back(GInstruction { ARRAY_ALLOCATE, new GOPARG[2] {
-          { tuple->registerNum }, { size->registerNum }
+    auto typeConstant = scope->environment->addConstant(GValue { .asType = tuple->type });
+    instr.push_back(GInstruction { ARRAY_ALLOCATE, new GOPARG[3] {
+          { tuple->registerNum }, { size->registerNum }, { .constantIndex = typeConstant }
     }});
     auto intVar = scope->allocateObject(getInt32Type());
     for (int i = 0; i < (int) values.size(); i++) {
-      auto value = values[i]->generateExpression(scope, instr);
+      auto value = values[i]->generateBoundExpression(scope, instr);
       instr.push_back(GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] {
             {intVar->registerNum}, {i}
       }});
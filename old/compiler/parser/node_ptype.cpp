@@ -9,7 +9,7 @@ using gstd::Array;
 namespace parser {
 
   GType* calculateType(GScope* scope, std::string name) {
-    auto typeObject  = scope->getClass(name);
+    auto typeObject  = scope->getClass(gstd::intern(name));
     if (typeObject == NULL) {
       typeObject = evaluateType(name);
     }
@@ -17,17 +17,17 @@ namespace parser {
   }
 
   PType* Parser::parseType() {
-    auto token = *token_position;
+    auto token = &*token_position;
     token_position++;
     switch(token->type) {
     case TYPE:
-      return new PSingleType(token->value);
+      return new PSingleType(token->value());
       break;
     case LPAREN: {
       std::vector<PType*> types;
-      while ((*token_position)->type != RPAREN) {
+      while (token_position->type != RPAREN) {
         types.push_back(parseType());
-        if ((*token_position)->type != RPAREN) {
+        if (token_position->type != RPAREN) {
           _validateToken(COMMA, "expected a comma in between tuple arguments");
           token_position++;
         }
@@ -35,7 +35,7 @@ namespace parser {
       token_position++;
 
       if (types.size() < 2) {
-        throw ParserException(**token_position,
+        throw ParserException(*token_position,
                               "Expected at least two types for a tuple type declaration");
       }
 
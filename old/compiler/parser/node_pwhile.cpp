@@ -15,10 +15,18 @@ namespace parser {
 
   void PWhile::generateStatement(codegen::GScope* scope,
                                  GInstructionVector& instr) {
-    int loopStart = instr.size();
+    // the condition is checked at the end of the loop, so an
+    // iteration only takes the one branch back to the start. we
+    // enter the loop by jumping straight to the condition.
+    codegen::GLabel loopStart, loopCondition;
+    instr.push_back(GInstruction { GOPCODE::GO, new GOPARG[1] { 0 }});
+    loopCondition.addJump(instr, 0);
+
+    loopStart.bind(instr);
     auto whileScope = scope->createChild(false);
-    auto statements = body->generate(whileScope);
+    body->generate(whileScope, instr);
 
+    loopCondition.bind(instr);
     auto conditionObject = condition->generateExpression(scope, instr);
     if (conditionObject->type != getBoolType()) {
       throw ParserException("While loop condition is not a boolean! found "
@@ -27,13 +35,10 @@ namespace parser {
 
     instr.push_back(GInstruction {
         GOPCODE::BRANCH, new GOPARG[3] {
-          { conditionObject->registerNum }, {1}, { (int) statements->size() + 2}
+          { conditionObject->registerNum }, { 0 }, { 1 }
         }
     });
-
-    instr.reserve(instr.size() + distance(statements->begin(), statements->end()));
-    instr.insert(instr.end(), statements->begin(), statements->end());
-    instr.push_back(GInstruction { GOPCODE::GO, new GOPARG[1] { - ((int) instr.size() - loopStart) }});
+    loopStart.addJump(instr, 1);
   }
 
   PWhile* Parser::parseWhile() {
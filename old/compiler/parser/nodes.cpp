@@ -19,7 +19,7 @@ namespace parser {
 
   YAML::Node* PClassDeclaration::toYaml() {
     auto root = new YAML::Node();
-    (*root)["class"]["name"] = name;
+    (*root)["class"]["name"] = gstd::symbolName(name);
 
     auto attributesYaml = new YAML::Node();
     for (auto attributeName: attributes) {
@@ -63,7 +63,7 @@ namespace parser {
 
   YAML::Node* PForeachLoop::toYaml() {
     auto root = new YAML::Node();
-    (*root)["foreach_loop"]["variable_name"] = variableName;
+    (*root)["foreach_loop"]["variable_name"] = gstd::symbolName(variableName);
     (*root)["foreach_loop"]["iterable"] = *iterableExpression->toYaml();
     (*root)["foreach_loop"]["block"] = *block->toYaml();
     return root;
@@ -72,11 +72,11 @@ namespace parser {
   YAML::Node* PFunctionDeclaration::toYaml() {
     auto root = new YAML::Node();
     (*root)["function_declaration"]["return_type"] = returnType->getName();
-    (*root)["function_declaration"]["name"] = name;
+    (*root)["function_declaration"]["name"] = gstd::symbolName(name);
 
     for (auto argument : arguments) {
       YAML::Node& argumentNode = *new YAML::Node();
-      argumentNode["name"] = argument->first;
+      argumentNode["name"] = gstd::symbolName(argument->first);
       argumentNode["type"] = argument->second;
       (*root)["function_declaration"]["arguments"].push_back(argumentNode);
     }
@@ -125,7 +125,7 @@ namespace parser {
 
   YAML::Node* PIdentifier::toYaml() {
     auto node = new YAML::Node();
-    (*node)["identifier"] = name;
+    (*node)["identifier"] = gstd::symbolName(name);
     return node;
   }
 
@@ -139,7 +139,7 @@ namespace parser {
 
   YAML::Node* PCall::toYaml() {
     auto node = new YAML::Node();
-    (*node)["function_call"]["name"] = name;
+    (*node)["function_call"]["name"] = gstd::symbolName(name);
     for (auto argument : arguments) {
       (*node)["function_call"]["arguments"].push_back(*argument->toYaml());
     }
@@ -156,7 +156,7 @@ namespace parser {
   YAML::Node* PMethodCall::toYaml() {
     auto node = new YAML::Node();
     (*node)["method_call"]["object"] = *currentValue->toYaml();
-    (*node)["method_call"]["method_name"] = methodName;
+    (*node)["method_call"]["method_name"] = gstd::symbolName(methodName);
     for (auto argument: arguments) {
       (*node)["method_call"]["arguments"].push_back(*argument->toYaml());
     }
@@ -166,7 +166,7 @@ namespace parser {
   YAML::Node* PPropertyAccess::toYaml() {
     auto node = new YAML::Node();
     (*node)["property_access"]["object"] = *currentValue->toYaml();
-    (*node)["property_access"]["name"] = propertyName;
+    (*node)["property_access"]["name"] = gstd::symbolName(propertyName);
     return node;
   }
 
@@ -4,6 +4,7 @@
 #include "../lexer/tokens.hpp"
 #include "../vm/vm.hpp"
 #include "../codegen/scope.hpp"
+#include "../codegen/label.hpp"
 #include "yaml-cpp/yaml.h"
 #include "../std/gstd.hpp"
 #include <string.h>
@@ -20,10 +21,20 @@ namespace parser {
   VM::GType* evaluateType(std::string);
   VM::GIndex* enforceLocal(codegen::GScope*, VM::GIndex*, GInstructionVector&);
 
+  // nodes are allocated from the compilation arena, and destroyed
+  // along with the rest of it once the bytecode is generated.
   class PNode {
   public:
     virtual YAML::Node* toYaml() = 0;
     virtual ~PNode() {};
+
+    static void* operator new(size_t size) {
+      return VM::getCompilationArena().allocate(size, &destroy);
+    }
+    static void operator delete(void*) {}
+    static void destroy(void* node) {
+      static_cast<PNode*>(node)->~PNode();
+    }
   };
 
   // the type node is used to evaluate types.
@@ -73,11 +84,36 @@ namespace parser {
     }
 
     virtual VM::GIndex* generateExpression(codegen::GScope*, GInstructionVector&) = 0;
-    virtual VM::GType* getType(codegen::GScope*) = 0;
+
+    // the expression as a value about to be bound to a variable, an
+    // element, an attribute or an argument, where it can be changed.
+    virtual VM::GIndex* generateBoundExpression(codegen::GScope* s, GInstructionVector& i) {
+      return generateExpression(s, i);
+    }
+
+    // the type of the expression. it's worked out the first time it's
+    // asked for, and kept on the node: expressions only appear once
+    // in the tree, so they're always typed against the same scope.
+    VM::GType* getType(codegen::GScope* scope) {
+      if (annotatedType == NULL) {
+        annotatedType = computeType(scope);
+      }
+      return annotatedType;
+    }
+
+    PExpression() : annotatedType(NULL) {}
+
+  protected:
+    VM::GType* annotatedType;
+    virtual VM::GType* computeType(codegen::GScope*) = 0;
   };
 
   typedef std::vector<PExpression*> PExpressions;
 
+  VM::GIndex* generateMethodCall(codegen::GScope*, GInstructionVector&,
+                                 VM::GIndex* object, VM::GFunction* method,
+                                 PExpressions& arguments);
+
   class PAssign : public PStatement {
   public:
     PExpression* identifier;
@@ -117,27 +153,27 @@ namespace parser {
 
   class PDeclare : public PStatement {
   public:
-    gstd::Array<std::string> names;
+    gstd::Array<gstd::Symbol> names;
     PExpression* expression;
 
     virtual YAML::Node* toYaml();
     virtual void generateStatement(codegen::GScope*, GInstructionVector&);
 
-    PDeclare(gstd::Array<std::string> _names,
+    PDeclare(gstd::Array<gstd::Symbol> _names,
              PExpression* _expression) :
       names(_names), expression(_expression) {}
   };
 
   class PForeachLoop : public PStatement {
   public:
-    std::string variableName;
+    gstd::Symbol variableName;
     PExpression* iterableExpression;
     PBlock* block;
 
     virtual YAML::Node* toYaml();
     virtual void generateStatement(codegen::GScope*, GInstructionVector&);
 
-    PForeachLoop(std::string _variableName,
+    PForeachLoop(gstd::Symbol _variableName,
              PExpression* _iterableExpression,
              PBlock* _block) :
       variableName(_variableName),
@@ -163,22 +199,25 @@ namespace parser {
       incrementer(_incrementer), body(_body) {}
   };
 
-  typedef std::pair<std::string, std::string> PArgumentDefinition;
+  // the name of an argument, and the name of its type.
+  typedef std::pair<gstd::Symbol, std::string> PArgumentDefinition;
   typedef std::vector<PArgumentDefinition*> PArgumentList;
 
   class PFunctionDeclaration : public PStatement {
   public:
     PType* returnType;
-    std::string name;
+    gstd::Symbol name;
     PArgumentList& arguments;
     PBlock* body;
 
     virtual YAML::Node* toYaml();
     virtual void generateStatement(codegen::GScope*, GInstructionVector&);
-    virtual void generateBody(VM::GFunction*, codegen::GScope*);
+    // classType is the class of the method, when it's one.
+    virtual void generateBody(VM::GFunction*, codegen::GScope*,
+                              VM::GType* classType = NULL);
 
     PFunctionDeclaration(PType* _returnType,
-                         std::string _name,
+                         gstd::Symbol _name,
                          PArgumentList& _arguments,
                          PBlock* _body) :
       returnType(_returnType), name(_name),
@@ -187,14 +226,14 @@ namespace parser {
 
   class PClassDeclaration : public PStatement {
   public:
-    std::string name;
+    gstd::Symbol name;
     std::map<std::string, std::string> attributes;
     std::vector<PFunctionDeclaration*> methods;
 
     virtual YAML::Node* toYaml();
     virtual void generateStatement(codegen::GScope*, GInstructionVector&);
 
-    PClassDeclaration(std::string _name): name(_name) {}
+    PClassDeclaration(gstd::Symbol _name): name(_name) {}
   };
 
   class PIfElse : public PStatement {
@@ -243,7 +282,7 @@ namespace parser {
     PType* type;
     PExpression* size;
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*);
+    virtual VM::GType* computeType(codegen::GScope*);
     virtual VM::GIndex* generateExpression(codegen::GScope*,
                                            GInstructionVector&);
     PArray(PType* _type, PExpression* _size) :
@@ -255,7 +294,7 @@ namespace parser {
     bool value;
 
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*) { return VM::getBoolType(); }
+    virtual VM::GType* computeType(codegen::GScope*) { return VM::getBoolType(); }
     virtual VM::GIndex* generateExpression(codegen::GScope* scope, GInstructionVector& instructions) {
       auto target = scope->allocateObject(VM::getBoolType());
       instructions.push_back(VM::GInstruction {
@@ -272,7 +311,7 @@ namespace parser {
   public:
     char value;
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*) { return VM::getCharType(); }
+    virtual VM::GType* computeType(codegen::GScope*) { return VM::getCharType(); }
     virtual VM::GIndex* generateExpression(codegen::GScope* scope, GInstructionVector& instructions) {
       auto target = scope->allocateObject(VM::getCharType());
       instructions.push_back(VM::GInstruction {
@@ -290,7 +329,7 @@ namespace parser {
     int value;
 
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*) { return VM::getInt32Type(); }
+    virtual VM::GType* computeType(codegen::GScope*) { return VM::getInt32Type(); }
     virtual VM::GIndex* generateExpression(codegen::GScope* s, GInstructionVector& i) {
       auto target = s->allocateObject(VM::getInt32Type());
       i.push_back(VM::GInstruction {
@@ -308,13 +347,14 @@ namespace parser {
     double value;
 
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*) { return VM::getFloatType(); }
+    virtual VM::GType* computeType(codegen::GScope*) { return VM::getFloatType(); }
 
     virtual VM::GIndex* generateExpression(codegen::GScope* s, GInstructionVector& instructions) {
       auto target = s->allocateObject(VM::getFloatType());
+      auto constantIndex = s->environment->addConstant(VM::GValue { .asFloat = value });
         instructions.push_back(VM::GInstruction {
             VM::LOAD_CONSTANT_FLOAT, new VM::GOPARG[2] {
-              { target->registerNum }, VM::GOPARG{ .asFloat = value }
+              { target->registerNum }, { constantIndex }
             }});
         return target;
     }
@@ -327,28 +367,29 @@ namespace parser {
     std::string value;
 
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*) { return VM::getStringType(); }
+    virtual VM::GType* computeType(codegen::GScope*) { return VM::getStringType(); }
     virtual VM::GIndex* generateExpression(codegen::GScope* s, GInstructionVector& i);
+    virtual VM::GIndex* generateBoundExpression(codegen::GScope* s, GInstructionVector& i);
 
     PConstantString(std::string _value) : value(_value) {};
   };
 
   class PIdentifier : public PExpression {
   public:
-    std::string name;
+    gstd::Symbol name;
 
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope* scope);
+    virtual VM::GType* computeType(codegen::GScope* scope);
     virtual VM::GIndex* generateExpression(codegen::GScope*, GInstructionVector&);
 
-    PIdentifier(std::string _name) : name(_name) {}
+    PIdentifier(gstd::Symbol _name) : name(_name) {}
   };
 
   class PConstantArray : public PExpression {
   public:
     std::vector<PExpression*>& elements;
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*) { return VM::getNoneType(); }
+    virtual VM::GType* computeType(codegen::GScope*) { return VM::getNoneType(); }
     virtual VM::GIndex* generateExpression(codegen::GScope*, GInstructionVector&);
 
     PConstantArray(std::vector<PExpression*>& _elements) :
@@ -357,14 +398,14 @@ namespace parser {
 
   class PCall : public PExpression {
   public:
-    std::string name;
+    gstd::Symbol name;
     PExpressions& arguments;
 
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*) { return VM::getNoneType(); }
+    virtual VM::GType* computeType(codegen::GScope*) { return VM::getNoneType(); }
     virtual VM::GIndex* generateExpression(codegen::GScope*, GInstructionVector&);
 
-    PCall(std::string _name,
+    PCall(gstd::Symbol _name,
           PExpressions& _arguments) :
       name(_name), arguments(_arguments) {}
   };
@@ -375,7 +416,7 @@ namespace parser {
     PExpression* index;
 
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*) { return VM::getNoneType(); };
+    virtual VM::GType* computeType(codegen::GScope*) { return VM::getNoneType(); };
     virtual VM::GIndex* generateExpression(codegen::GScope*, GInstructionVector&);
 
     PArrayAccess(PExpression* _value,
@@ -386,15 +427,15 @@ namespace parser {
   class PMethodCall : public PExpression {
   public:
     PExpression* currentValue;
-    std::string methodName;
+    gstd::Symbol methodName;
     PExpressions& arguments;
 
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*);
+    virtual VM::GType* computeType(codegen::GScope*);
     virtual VM::GIndex* generateExpression(codegen::GScope*, GInstructionVector&);
 
     PMethodCall(PExpression* _currentValue,
-                std::string _methodName,
+                gstd::Symbol _methodName,
                 PExpressions& _arguments) :
       currentValue(_currentValue),
       methodName(_methodName),
@@ -404,13 +445,13 @@ namespace parser {
   class PPropertyAccess : public PExpression {
   public:
     PExpression* currentValue;
-    std::string propertyName;
+    gstd::Symbol propertyName;
 
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*) { return NULL; }
+    virtual VM::GType* computeType(codegen::GScope*) { return NULL; }
     virtual VM::GIndex* generateExpression(codegen::GScope*, GInstructionVector&);
 
-    PPropertyAccess(PExpression* _currentValue, std::string _propertyName) :
+    PPropertyAccess(PExpression* _currentValue, gstd::Symbol _propertyName) :
       currentValue(_currentValue), propertyName(_propertyName) {}
   };
 
@@ -418,7 +459,7 @@ namespace parser {
   public:
     std::vector<PExpression*> values;
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope*);
+    virtual VM::GType* computeType(codegen::GScope*);
     virtual VM::GIndex* generateExpression(codegen::GScope*, GInstructionVector&);
     PTuple(std::vector<PExpression*> _values) : values(_values) {};
   };
@@ -430,7 +471,7 @@ namespace parser {
     PExpression* rhs;
 
     virtual YAML::Node* toYaml();
-    virtual VM::GType* getType(codegen::GScope* s) {
+    virtual VM::GType* computeType(codegen::GScope* s) {
       switch (op) {
       case lexer::L::OR:
       case lexer::L::LESS_THAN:
@@ -458,11 +499,11 @@ namespace parser {
   public:
     PStatements statements;
     virtual YAML::Node* toYaml();
-    GInstructionVector* generate(codegen::GScope*);
+    void generate(codegen::GScope*, GInstructionVector&);
   };
 
   // we'll stick it here for now, move it somewhere else later
-  VM::GInstruction* generateRoot(VM::GEnvironment*, PBlock*);
+  VM::GBytecode* generateRoot(VM::GEnvironment*, PBlock*);
 }
 
 #endif
@@ -23,10 +23,10 @@ namespace parser {
       debug("validateToken: at end");
       throw ParserException(message);
 
-    } else if ((*token_position)->type != type) {
+    } else if (token_position->type != type) {
       debug("validateToken: type mismatch");
-      throw ParserException(**token_position,
-                            message + " found " + (*token_position)->getDescription());
+      throw ParserException(*token_position,
+                            message + " found " + token_position->getDescription());
 
     }
   }
@@ -36,7 +36,7 @@ namespace parser {
     auto block = new PBlock();
 
     while (token_position != tokens.end()
-           && (*token_position)->type != UNINDENT) {
+           && token_position->type != UNINDENT) {
       auto statement = parseStatement();
       block->statements.push_back(statement);
     }
@@ -52,7 +52,7 @@ namespace parser {
     token_position++;
 
     _validateToken(L::TYPE, "expected a class name for a class declaration");
-    auto name = (*token_position)->value;
+    auto name = token_position->symbol;
     token_position++;
 
     _validateToken(L::COLON, "expected a ':' for a class declaration");
@@ -63,21 +63,21 @@ namespace parser {
 
     auto pclass = new PClassDeclaration(name);
 
-    while (token_position != tokens.end() && (*token_position)->type != UNINDENT) {
-      auto token = *token_position;
+    while (token_position != tokens.end() && token_position->type != UNINDENT) {
+      auto token = &*token_position;
       switch (token->type) {
 
       case IDENTIFIER:
         {
           if (token_position + 1 == tokens.end() || token_position + 2 == tokens.end()) {
-            throw ParserException(**token_position, "reached EOF while parsing class declaration");
+            throw ParserException(*token_position, "reached EOF while parsing class declaration");
           }
 
-          auto attributeName = token->value;
+          auto attributeName = token->value();
           token_position++;
 
           _validateToken(L::TYPE, "expected a type for a class attribute declaration");
-          auto typeName = (*(token_position))->value;
+          auto typeName = token_position->value();
 
           pclass->attributes[attributeName] = typeName;
           token_position++;
@@ -116,7 +116,7 @@ namespace parser {
 
     PBlock* falseBlock = NULL;
 
-    if (token_position != tokens.end() && (*token_position)->type == ELSE) {
+    if (token_position != tokens.end() && token_position->type == ELSE) {
         token_position++;
 
         _validateToken(COLON, "expected an ':' for an else statement");
@@ -139,13 +139,13 @@ namespace parser {
     _validateToken(L_BRACKET, "expected an '[' for an array");
     token_position++;
 
-    auto elements = new std::vector<PExpression*>;
+    auto elements = getCompilationArena().make<std::vector<PExpression*>>();
 
-    while ((*token_position)->type != R_BRACKET) {
+    while (token_position->type != R_BRACKET) {
       elements->push_back(parseExpression());
-      if ((*token_position)->type != R_BRACKET) {
-        if ((*token_position)->type != COMMA) {
-          throw ParserException(**token_position,
+      if (token_position->type != R_BRACKET) {
+        if (token_position->type != COMMA) {
+          throw ParserException(*token_position,
                                 "expected a ',' in between arguments.");
         }
         token_position++;
@@ -160,7 +160,7 @@ namespace parser {
 
   PStatement* Parser::parseStatement() {
     debug("parseStatement");
-    auto token = *token_position;
+    auto token = &*token_position;
 
     switch (token->type) {
 
@@ -175,15 +175,15 @@ namespace parser {
     case IDENTIFIER: {
       // we collect the identifiers
       // it could be a tuple
-      auto identifiers = new std::vector<std::string>();
-      while ((*token_position)->type == IDENTIFIER) {
-        identifiers->push_back((*token_position)->value);
+      auto identifiers = getCompilationArena().make<std::vector<gstd::Symbol>>();
+      while (token_position->type == IDENTIFIER) {
+        identifiers->push_back(token_position->symbol);
         token_position++;
-        if ((*token_position)->type == IDENTIFIER) {
-          throw ParserException(**token_position,
+        if (token_position->type == IDENTIFIER) {
+          throw ParserException(*token_position,
                                 "multiple identifiers must be separated by a comma");
         }
-        if ((*token_position)->type == COMMA) {
+        if (token_position->type == COMMA) {
           token_position++;
         }
       }
@@ -195,16 +195,16 @@ namespace parser {
 
       // declare is the only type that can take a
       // tuple right now.
-      if ((*token_position)->type == DECLARE) {
+      if (token_position->type == DECLARE) {
         debug("pDeclare");
         token_position++; // iterate past declare
         auto expression = parseExpression();
-        Array<std::string> identifierArray(&(*identifiers)[0], identifiers->size());
+        Array<gstd::Symbol> identifierArray(&(*identifiers)[0], identifiers->size());
         return new PDeclare(identifierArray, expression);
       }
 
       if (identifiers->size() > 1) {
-        throw ParserException(**token_position, "found an unexpected statement with the tuple on the lhs!");
+        throw ParserException(*token_position, "found an unexpected statement with the tuple on the lhs!");
       }
 
       token_position--;
@@ -220,7 +220,7 @@ namespace parser {
         return identExpression;
       }
 
-      switch ((*token_position)->type) {
+      switch (token_position->type) {
 
       case ASSIGN:
         token_position++;
@@ -266,27 +266,27 @@ namespace parser {
     auto returnType = parseType();
 
     _validateToken(IDENTIFIER, "expected a function name for a function declaration");
-    auto functionName = (*token_position)->value;
+    auto functionName = token_position->symbol;
     token_position++;
 
     _validateToken(LPAREN, "expected a '(' for a method call!");
     token_position++; // iterate past a left paren
 
-    auto arguments = new PArgumentList();
+    auto arguments = getCompilationArena().make<PArgumentList>();
 
-    while ((*token_position)->type != RPAREN) {
+    while (token_position->type != RPAREN) {
 
       _validateToken(IDENTIFIER, "expected a variable name for a function declaration");
-      auto variableName = (*token_position)->value;
+      auto variableName = token_position->symbol;
       token_position++;
 
       _validateToken(TYPE, "expected a class name for a function declaration");
-      auto typeName = (*token_position)->value;
+      auto typeName = token_position->value();
       token_position++;
 
-      arguments->push_back(new PArgumentDefinition(variableName, typeName));
+      arguments->push_back(getCompilationArena().make<PArgumentDefinition>(variableName, typeName));
 
-      if ((*token_position)->type == COMMA) {
+      if (token_position->type == COMMA) {
         token_position++;
       }
 
@@ -325,9 +325,9 @@ namespace parser {
     _validateToken(FOR, "expected a 'for' for a for loop");
     token_position++;
 
-    switch((*token_position)->type) {
+    switch(token_position->type) {
     case IDENTIFIER:
-      if ((*(token_position + 1))->type == IN) {
+      if ((token_position + 1)->type == IN) {
         return parseForeachLoop();
       }
     default:
@@ -339,7 +339,7 @@ namespace parser {
     debug("parseForLoop");
 
     _validateToken(IDENTIFIER, "expected a identifier for a for loop");
-    auto variableName = (*token_position)->value;
+    auto variableName = token_position->symbol;
     token_position++;
 
     _validateToken(IN, "expected a in for a for loop");
@@ -389,7 +389,7 @@ namespace parser {
   }
 
   PCall* Parser::parseClassInstantiation() {
-    auto className = (*token_position)->value;
+    auto className = token_position->symbol;
     token_position++;
 
     auto arguments = parseArgumentsParens();
@@ -38,9 +38,9 @@ namespace parser {
     std::stack<lexer::L> operators;
 
     values.push(parseValue());
-    while (token_position != tokens.end() && isBinaryOperator(**token_position)) {
-      debug("Parser::parseBinaryOperations: parsing token " << (*token_position)->getFullDescription());
-      auto op = (*token_position)->type;
+    while (token_position != tokens.end() && isBinaryOperator(*token_position)) {
+      debug("Parser::parseBinaryOperations: parsing token " << token_position->getFullDescription());
+      auto op = token_position->type;
 
       while (true) {
         if (operators.size() == 0) {
@@ -100,7 +100,7 @@ namespace parser {
 
       // now we check to see if we're
       // accessing an array or it's function call
-      switch((*token_position)->type) {
+      switch(token_position->type) {
       case DOT:
         baseValue = parseMethodCall(baseValue);
         break;
@@ -123,12 +123,12 @@ namespace parser {
 
     _validateToken(IDENTIFIER, "expected an identifier for a method call");
     debug("parsing identifier...");
-    auto methodName = (*token_position)->value;
+    auto methodName = token_position->symbol;
     token_position++;
 
     PExpressions* arguments;
 
-    if (token_position != tokens.end() && (*token_position)->type == LPAREN) {
+    if (token_position != tokens.end() && token_position->type == LPAREN) {
       debug("parseMethodCall: found method call, creating PCallMethod..");
       arguments = parseArgumentsParens();
 
@@ -149,7 +149,7 @@ namespace parser {
     debug("parseCall");
 
     _validateToken(IDENTIFIER, "expected an identifier for a function call");
-    auto name = (*token_position)->value;
+    auto name = token_position->symbol;
     token_position++;
 
     PExpressions* arguments = parseArgumentsParens();
@@ -174,7 +174,7 @@ namespace parser {
 
   PExpression* Parser::parseBaseValue() {
     debug("parseBaseValue");
-    auto token = *token_position;
+    auto token = &*token_position;
     token_position++;
     switch(token->type) {
 
@@ -185,7 +185,7 @@ namespace parser {
 
     case TYPE: {
 
-      auto nextTokenType = (*token_position)->type;
+      auto nextTokenType = token_position->type;
       token_position--;
 
       switch (nextTokenType) {
@@ -209,28 +209,28 @@ namespace parser {
 
     case L::STRING:
       debug("parseBaseValue: returning string.");
-      return new PConstantString(token->value);
+      return new PConstantString(token->value());
 
     case CHAR:
       debug("parseBaseValue: returning char.");
-      return new PConstantChar(token->value[0]);
+      return new PConstantChar(token->value()[0]);
 
     case INT:
       debug("parseBaseValue: returning int.");
-      return new PConstantInt(std::stoi(token->value));
+      return new PConstantInt(std::stoi(token->value()));
 
     case DOUBLE:
       debug("parseBaseValue: returning double.");
-      return new PConstantFloat(std::stod(token->value));
+      return new PConstantFloat(std::stod(token->value()));
 
     case IDENTIFIER: {
       debug("parseBaseValue: return identifier.");
 
-      if ((*token_position)->type == LPAREN) {
+      if (token_position->type == LPAREN) {
         token_position--;
         return parseCall();
       } else {
-        return new PIdentifier(token->value);
+        return new PIdentifier(token->symbol);
       }
     }
 
@@ -246,7 +246,7 @@ namespace parser {
       debug("parseBaseValue: return subexpression");
       auto value = parseExpression();
 
-      switch ((*token_position)->type) {
+      switch (token_position->type) {
       case RPAREN:
         token_position++;
         return value;
@@ -255,10 +255,10 @@ namespace parser {
         token_position++;
         std::vector<PExpression*> values;
         values.push_back(value);
-        while ((*token_position)->type != RPAREN) {
+        while (token_position->type != RPAREN) {
           auto value = parseExpression();
           values.push_back(value);
-          if ((*token_position)->type != RPAREN) {
+          if (token_position->type != RPAREN) {
             _validateToken(COMMA, "expected a comma for a tuple value");
             token_position++;
           }
@@ -278,13 +278,13 @@ namespace parser {
   }
 
   PExpressions* Parser::parseArguments() {
-    auto arguments = new PExpressions();
+    auto arguments = getCompilationArena().make<PExpressions>();
 
-    while ((*token_position)->type != RPAREN) {
+    while (token_position->type != RPAREN) {
       arguments->push_back(parseExpression());
-      if ((*token_position)->type != RPAREN) {
-        if ((*token_position)->type != COMMA) {
-          throw ParserException(**token_position,
+      if (token_position->type != RPAREN) {
+        if (token_position->type != COMMA) {
+          throw ParserException(*token_position,
                                 "expected a ',' in between arguments.");
         }
         token_position++;
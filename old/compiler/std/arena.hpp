@@ -0,0 +1,108 @@
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef GSTD_ARENA_HPP
+#define GSTD_ARENA_HPP
+
+namespace gstd {
+
+  /*
+    hands out memory for objects that all die at the same time, from
+    a few large blocks rather than an allocation each. reset()
+    destroys the objects that asked to be, and releases all of it at
+    once.
+   */
+  class Arena {
+  public:
+    typedef void (*Destructor)(void*);
+
+    static const size_t BLOCK_SIZE = 64 * 1024;
+    static const size_t ALIGNMENT = 16;
+
+    // since the last reset.
+    size_t bytesAllocated;
+    int allocations;
+
+    Arena() : bytesAllocated(0), allocations(0), current(NULL), limit(NULL) {}
+
+    ~Arena() {
+      reset();
+      if (blocks.size() > 0) {
+        delete[] blocks[0].first;
+      }
+    }
+
+    void* allocate(size_t size) {
+      size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+      if ((size_t) (limit - current) < size) {
+        grow(size);
+      }
+      auto memory = current;
+      current += size;
+      bytesAllocated += size;
+      allocations++;
+      return memory;
+    }
+
+    // memory for an object that's destroyed on reset. the object
+    // can't throw while it's constructed, as it's already registered.
+    void* allocate(size_t size, Destructor destructor) {
+      auto memory = allocate(size);
+      destructors.push_back(std::make_pair(memory, destructor));
+      return memory;
+    }
+
+    template <class T, class... Args>
+    T* make(Args&&... args) {
+      auto object = new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+      if (!std::is_trivially_destructible<T>::value) {
+        destructors.push_back(std::make_pair((void*) object, &destroy<T>));
+      }
+      return object;
+    }
+
+    // everything goes, except the first block, which is kept for
+    // the next round of allocations.
+    void reset() {
+      for (auto it = destructors.rbegin(); it != destructors.rend(); ++it) {
+        it->second(it->first);
+      }
+      destructors.clear();
+
+      if (blocks.size() > 0) {
+        for (size_t i = 1; i < blocks.size(); i++) {
+          delete[] blocks[i].first;
+        }
+        blocks.resize(1);
+        current = blocks[0].first;
+        limit = current + blocks[0].second;
+      }
+      bytesAllocated = 0;
+      allocations = 0;
+    }
+
+  private:
+    std::vector<std::pair<char*, size_t>> blocks;
+    std::vector<std::pair<void*, Destructor>> destructors;
+    char* current;
+    char* limit;
+
+    void grow(size_t size) {
+      auto blockSize = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+      auto block = new char[blockSize];
+      blocks.push_back(std::make_pair(block, blockSize));
+      current = block;
+      limit = block + blockSize;
+    }
+
+    template <class T>
+    static void destroy(void* object) {
+      static_cast<T*>(object)->~T();
+    }
+  };
+}
+
+#endif
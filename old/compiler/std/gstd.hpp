@@ -1 +1,4 @@
 #include "array.hpp"
+#include "arena.hpp"
+#include "symbols.hpp"
+#include "symbol_map.hpp"
@@ -0,0 +1,114 @@
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "symbols.hpp"
+
+#ifndef GSTD_SYMBOL_MAP_HPP
+#define GSTD_SYMBOL_MAP_HPP
+
+namespace gstd {
+
+  /*
+    a map from symbols to values. the entries are kept in a vector, in
+    the order they were added, and found through an open addressing
+    table of their positions in it. lookups hash an int rather than
+    compare strings, and copying a map copies two vectors rather than
+    a node per entry.
+   */
+  template <class V>
+  class SymbolMap {
+  public:
+    typedef std::pair<Symbol, V> Entry;
+    typedef typename std::vector<Entry>::iterator iterator;
+    typedef typename std::vector<Entry>::const_iterator const_iterator;
+
+    // NULL if the symbol isn't in the map.
+    V* find(Symbol symbol) {
+      int entry = findEntry(symbol);
+      return entry == EMPTY ? NULL : &entries[entry].second;
+    }
+
+    const V* find(Symbol symbol) const {
+      int entry = findEntry(symbol);
+      return entry == EMPTY ? NULL : &entries[entry].second;
+    }
+
+    bool contains(Symbol symbol) const {
+      return findEntry(symbol) != EMPTY;
+    }
+
+    V& operator[](Symbol symbol) {
+      if (slots.size() > 0) {
+        auto mask = slots.size() - 1;
+        for (auto i = slotFor(symbol, mask);; i = (i + 1) & mask) {
+          if (slots[i] == EMPTY) {
+            break;
+          }
+          if (entries[slots[i]].first == symbol) {
+            return entries[slots[i]].second;
+          }
+        }
+      }
+      entries.push_back(std::make_pair(symbol, V()));
+      if (entries.size() * 2 > slots.size()) {
+        rehash(slots.size() == 0 ? INITIAL_SLOTS : slots.size() * 2);
+      } else {
+        place(entries.size() - 1);
+      }
+      return entries.back().second;
+    }
+
+    int size() const { return entries.size(); }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+  private:
+    enum { EMPTY = -1 };
+    static const size_t INITIAL_SLOTS = 8;
+
+    std::vector<Entry> entries;
+    // the position in entries of the symbol hashed to each slot.
+    std::vector<int> slots;
+
+    static size_t slotFor(Symbol symbol, size_t mask) {
+      return ((uint32_t) symbol * 2654435761u) & mask;
+    }
+
+    int findEntry(Symbol symbol) const {
+      if (slots.size() == 0) {
+        return EMPTY;
+      }
+      auto mask = slots.size() - 1;
+      for (auto i = slotFor(symbol, mask);; i = (i + 1) & mask) {
+        int entry = slots[i];
+        if (entry == EMPTY || entries[entry].first == symbol) {
+          return entry;
+        }
+      }
+    }
+
+    void place(int entry) {
+      auto mask = slots.size() - 1;
+      auto i = slotFor(entries[entry].first, mask);
+      while (slots[i] != EMPTY) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = entry;
+    }
+
+    void rehash(size_t slotCount) {
+      slots.assign(slotCount, EMPTY);
+      for (int entry = 0; entry < (int) entries.size(); entry++) {
+        place(entry);
+      }
+    }
+  };
+
+  template <class V>
+  const size_t SymbolMap<V>::INITIAL_SLOTS;
+}
+
+#endif
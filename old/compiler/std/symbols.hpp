@@ -0,0 +1,110 @@
+#include <stdint.h>
+#include <string.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+#ifndef GSTD_SYMBOLS_HPP
+#define GSTD_SYMBOLS_HPP
+
+namespace gstd {
+
+  // an interned name. two names are the same symbol exactly when
+  // they're spelled the same, so comparing names is comparing ints.
+  typedef int Symbol;
+
+  const Symbol NO_SYMBOL = -1;
+
+  /*
+    hands out a symbol for each distinct name, numbered from 0 in the
+    order they're first seen. names are looked up in an open
+    addressing table of symbols, so interning a name that's already
+    known doesn't allocate.
+   */
+  class SymbolTable {
+  public:
+    SymbolTable() : slots(INITIAL_SLOTS, NO_SYMBOL) {}
+
+    Symbol intern(const char* text, int length) {
+      auto hash = hashName(text, length);
+      auto mask = slots.size() - 1;
+      for (auto i = hash & mask;; i = (i + 1) & mask) {
+        auto symbol = slots[i];
+        if (symbol == NO_SYMBOL) {
+          symbol = names.size();
+          names.push_back(std::string(text, length));
+          hashes.push_back(hash);
+          slots[i] = symbol;
+          if (names.size() * 2 > slots.size()) {
+            grow();
+          }
+          return symbol;
+        }
+        auto& name = names[symbol];
+        if (hashes[symbol] == hash && (int) name.size() == length &&
+            memcmp(name.data(), text, length) == 0) {
+          return symbol;
+        }
+      }
+    }
+
+    Symbol intern(const std::string& name) {
+      return intern(name.data(), name.size());
+    }
+
+    // names don't move once they're interned.
+    const std::string& name(Symbol symbol) const {
+      return names[symbol];
+    }
+
+    int size() const { return names.size(); }
+
+  private:
+    enum { INITIAL_SLOTS = 1024 };
+
+    std::deque<std::string> names;
+    std::vector<uint32_t> hashes;
+    std::vector<Symbol> slots;
+
+    // fnv-1a.
+    static uint32_t hashName(const char* text, int length) {
+      uint32_t hash = 2166136261u;
+      for (int i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char) text[i]) * 16777619u;
+      }
+      return hash;
+    }
+
+    void grow() {
+      slots.assign(slots.size() * 2, NO_SYMBOL);
+      auto mask = slots.size() - 1;
+      for (Symbol symbol = 0; symbol < (Symbol) names.size(); symbol++) {
+        auto i = hashes[symbol] & mask;
+        while (slots[i] != NO_SYMBOL) {
+          i = (i + 1) & mask;
+        }
+        slots[i] = symbol;
+      }
+    }
+  };
+
+  // the one table every name in the compiler is interned in.
+  inline SymbolTable& getSymbolTable() {
+    static SymbolTable table;
+    return table;
+  }
+
+  inline Symbol intern(const char* text, int length) {
+    return getSymbolTable().intern(text, length);
+  }
+
+  inline Symbol intern(const std::string& name) {
+    return getSymbolTable().intern(name);
+  }
+
+  inline const std::string& symbolName(Symbol symbol) {
+    return getSymbolTable().name(symbol);
+  }
+}
+
+#endif
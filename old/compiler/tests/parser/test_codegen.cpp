@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "../../lexer/tokenizer.hpp"
+#include "../../parser/parser.hpp"
+#include "../../vm/vm.hpp"
+#include "../../vm/execution_engine.hpp"
+#include "../../vm/rootenvironment.hpp"
+#include "../../vm/types/string.hpp"
+
+using namespace lexer;
+using namespace parser;
+using namespace VM;
+
+// compiles source into module and runs it, returning the registers of
+// the module to read its variables from.
+static GValue* run(GEnvironment* module, const std::string& source) {
+  module->parent = &getBaseEnvironment();
+  Tokenizer tokenizer;
+  std::istringstream input(source);
+  auto tokens = tokenizer.tokenize(input);
+  Parser parser(tokens);
+  auto bytecode = generateRoot(module, parser.parseBlock());
+  getCompilationArena().reset();
+
+  auto registers = new GValue[module->localsCount]();
+  GEnvironmentInstance scope {
+    .environment = module,
+    .globals = module->resolveGlobals(getBaseEnvironmentInstance()),
+    .locals = registers
+  };
+  executeInstructions(NULL, bytecode, scope);
+  return registers;
+}
+
+static std::string getString(GEnvironment* module, GValue* registers,
+                             const std::string& name) {
+  auto string = registers[module->getObject(name)->registerNum].asString;
+  return std::string(string->bytes, string->size);
+}
+
+// literals are shared, but each place one's stored in gets a string
+// of its own, that's changed in place.
+TEST(Codegen, literalInArrayIsChanged) {
+  auto module = new GEnvironment();
+  auto registers = run(module,
+                       "strs := [\"abc\", \"def\"]\n"
+                       "strs[0][0] = 'x'\n"
+                       "first := strs[0]\n"
+                       "other := \"abc\"\n");
+  EXPECT_EQ(getString(module, registers, "first"), "xbc");
+  EXPECT_EQ(getString(module, registers, "other"), "abc");
+}
+
+TEST(Codegen, literalArgumentIsChanged) {
+  auto module = new GEnvironment();
+  auto registers = run(module,
+                       "None change(s String):\n"
+                       "\ts[0] = 'j'\n"
+                       "\n"
+                       "a := \"abc\"\n"
+                       "change(a)\n"
+                       "b := a\n"
+                       "b[1] = 'k'\n");
+  EXPECT_EQ(getString(module, registers, "a"), "jkc");
+}
+
+static int getInt(GEnvironment* module, GValue* registers,
+                  const std::string& name) {
+  return registers[module->getObject(name)->registerNum].asInt32;
+}
+
+// methods of a class declared in a function see the call of it that
+// created their instance, even once another call has declared it again.
+TEST(Codegen, classInFunction) {
+  auto module = new GEnvironment();
+  auto registers = run(module,
+                       "Int f(x Int):\n"
+                       "\tclass Foo:\n"
+                       "\t\ta Int\n"
+                       "\t\tInt plus():\n"
+                       "\t\t\treturn a + x\n"
+                       "\tfoo := Foo(1)\n"
+                       "\tif 0 < x:\n"
+                       "\t\tf(x - 1)\n"
+                       "\treturn foo.plus()\n"
+                       "\n"
+                       "simple := f(0)\n"
+                       "nested := f(2)\n");
+  EXPECT_EQ(getInt(module, registers, "simple"), 1);
+  EXPECT_EQ(getInt(module, registers, "nested"), 3);
+}
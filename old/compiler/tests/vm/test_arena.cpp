@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+#include "../../vm/vm.hpp"
+#include "../../std/arena.hpp"
+
+using namespace VM;
+
+static int destroyed;
+
+struct Tracked {
+  int value;
+  Tracked(int _value) : value(_value) {}
+  ~Tracked() { destroyed++; }
+};
+
+TEST(Arena, reset) {
+  gstd::Arena arena;
+  destroyed = 0;
+  auto first = arena.make<Tracked>(1);
+  arena.make<Tracked>(2);
+  // bigger than a block gets a block of its own.
+  arena.allocate(gstd::Arena::BLOCK_SIZE * 2);
+  EXPECT_EQ(first->value, 1);
+  EXPECT_EQ(arena.allocations, 3);
+
+  arena.reset();
+  EXPECT_EQ(destroyed, 2);
+  EXPECT_EQ(arena.allocations, 0);
+  // the memory is handed out again.
+  EXPECT_EQ((void*) arena.make<Tracked>(3), (void*) first);
+}
+
+// the indices codegen passes around come out of the compilation arena.
+TEST(Arena, indices) {
+  auto& arena = getCompilationArena();
+  auto environment = new GEnvironment();
+  environment->addObject("x", getInt32Type());
+  int allocations = arena.allocations;
+  auto index = environment->getObject("x");
+  EXPECT_EQ(index->registerNum, 0);
+  EXPECT_EQ(arena.allocations, allocations + 1);
+}
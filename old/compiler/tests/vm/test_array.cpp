@@ -6,8 +6,9 @@ using namespace VM;
 
 
 TEST(VM, array_access) {
-  auto instructions = new GInstruction[10] {
-    GInstruction { ARRAY_ALLOCATE, new GOPARG[2] { 0, 2 }},
+  auto instructions = new GInstruction[11] {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 6, 2 }},
+    GInstruction { ARRAY_ALLOCATE, new GOPARG[3] { 0, 6, 0 }},
 
     GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 10 }},
     GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 2, 0 }},
@@ -21,9 +22,35 @@ TEST(VM, array_access) {
     GInstruction { PRINT_INT, new GOPARG[1] { 5 } },
     GInstruction { END, NULL }
   };
-  auto registers = new GValue[6];
+  std::vector<GValue> constants { GValue { .asType = getArrayType(getInt32Type()) }};
+  auto bytecode = assembleBytecode(instructions, 11, constants);
+  auto registers = new GValue[7];
   GEnvironmentInstance scope {
+    .environment = getEmptyEnvironment(),
     .locals = registers
   };
-  executeInstructions(NULL, instructions, scope);
+  executeInstructions(NULL, bytecode, scope);
+  EXPECT_EQ(registers[5].asInt32, 20);
+}
+
+TEST(VM, primitiveMethodCall) {
+  // the method is a constant, resolved before the call runs.
+  std::vector<GValue> constants {
+    GValue { .asType = getArrayType(getInt32Type()) },
+    GValue { .asPrimitiveMethod = arrayMethods["size"].rawMethod }
+  };
+  GInstruction instructions[] = {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 4 }},
+    GInstruction { ARRAY_ALLOCATE, new GOPARG[3] { 0, 1, 0 }},
+    GInstruction { PRIMITIVE_METHOD_CALL, new GOPARG[3] { 2, 0, 1 }},
+    GInstruction { END, NULL }
+  };
+  auto bytecode = assembleBytecode(instructions, 4, constants);
+  auto registers = new GValue[3];
+  GEnvironmentInstance scope {
+    .environment = getEmptyEnvironment(),
+    .locals = registers
+  };
+  executeInstructions(NULL, bytecode, scope);
+  EXPECT_EQ(registers[2].asInt32, 4);
 }
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "../../vm/vm.hpp"
+#include "../../vm/execution_engine.hpp"
+
+using namespace VM;
+
+TEST(Bytecode, operandsAreInline) {
+  GInstruction instructions[] = {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 0, 3 }},
+    GInstruction { ADD_INT, new GOPARG[3] { 0, 0, 1 }},
+    GInstruction { END, NULL }
+  };
+  std::vector<GValue> constants;
+  auto bytecode = assembleBytecode(instructions, 3, constants);
+
+  EXPECT_EQ(bytecode->size, 3 + 4 + 1);
+  EXPECT_EQ(getOpcode(bytecode->code[0]), LOAD_CONSTANT_INT);
+  EXPECT_EQ(bytecode->code[2].asInt32, 3);
+  EXPECT_EQ(getOpcode(bytecode->code[3]), ADD_INT);
+  EXPECT_EQ(bytecode->code[6].registerNum, 1);
+  EXPECT_EQ(getOpcode(bytecode->code[7]), END);
+}
+
+TEST(Bytecode, jumpsAreInWords) {
+  // a loop counting down from 3 to 0.
+  GInstruction instructions[] = {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 0, 3 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 1 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 2, 0 }},
+    GInstruction { SUBTRACT_INT, new GOPARG[3] { 0, 1, 0 }},
+    GInstruction { LESS_THAN_INT, new GOPARG[3] { 2, 0, 3 }},
+    GInstruction { BRANCH, new GOPARG[3] { 3, -2, 1 }},
+    GInstruction { END, NULL }
+  };
+  std::vector<GValue> constants;
+  auto bytecode = assembleBytecode(instructions, 7, constants);
+
+  // the branch starts at word 17, and jumps back to the SUBTRACT_INT
+  // at word 9, or forward to the END at word 21.
+  EXPECT_EQ(getOpcode(bytecode->code[17]), BRANCH);
+  EXPECT_EQ(bytecode->code[19].positionDiff, -8);
+  EXPECT_EQ(bytecode->code[20].positionDiff, 4);
+
+  auto registers = new GValue[4];
+  GEnvironmentInstance scope {
+    .environment = getEmptyEnvironment(),
+    .locals = registers
+  };
+  executeInstructions(NULL, bytecode, scope);
+  EXPECT_EQ(registers[0].asInt32, 0);
+}
+
+TEST(Bytecode, constantPool) {
+  std::vector<GValue> constants;
+  constants.push_back(GValue { .asFloat = 1.5 });
+  GInstruction instructions[] = {
+    GInstruction { LOAD_CONSTANT_FLOAT, new GOPARG[2] { 0, 0 }},
+    GInstruction { END, NULL }
+  };
+  auto bytecode = assembleBytecode(instructions, 2, constants);
+
+  EXPECT_EQ(bytecode->constantsCount, 1);
+  auto registers = new GValue[1];
+  GEnvironmentInstance scope {
+    .environment = getEmptyEnvironment(),
+    .locals = registers
+  };
+  executeInstructions(NULL, bytecode, scope);
+  EXPECT_EQ(registers[0].asFloat, 1.5);
+}
+
+TEST(Bytecode, variableLengthInstructions) {
+  GInstruction instructions[] = {
+    GInstruction { FUNCTION_CALL, new GOPARG[5] { 0, 1, 2, 3, 4 }},
+    GInstruction { END, NULL }
+  };
+  std::vector<GValue> constants;
+  auto bytecode = assembleBytecode(instructions, 2, constants);
+
+  EXPECT_EQ(getInstructionSize(bytecode->code), 6);
+  EXPECT_EQ(getOpcode(bytecode->code[6]), END);
+}
+
+TEST(Bytecode, superinstructions) {
+  GInstruction instructions[] = {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 0, 5 }},
+    GInstruction { INC_INT, new GOPARG[1] { 0 }},
+    GInstruction { ADD_INT_IMM, new GOPARG[3] { 0, 10, 1 }},
+    GInstruction { LOAD_CONST_ADD, new GOPARG[4] { 2, 3, 1, 3 }},
+    GInstruction { BRANCH_IF_EQ_INT, new GOPARG[4] { 0, 2, 1, 2 }},
+    GInstruction { INC_INT, new GOPARG[1] { 0 }},
+    GInstruction { BRANCH_IF_LT_INT, new GOPARG[4] { 2, 0, 2, 1 }},
+    GInstruction { INC_INT, new GOPARG[1] { 0 }},
+    GInstruction { END, NULL }
+  };
+  std::vector<GValue> constants;
+  auto bytecode = assembleBytecode(instructions, 9, constants);
+
+  auto registers = new GValue[4];
+  GEnvironmentInstance scope {
+    .environment = getEmptyEnvironment(),
+    .locals = registers
+  };
+  executeInstructions(NULL, bytecode, scope);
+  EXPECT_EQ(registers[1].asInt32, 16);
+  EXPECT_EQ(registers[2].asInt32, 3);
+  EXPECT_EQ(registers[3].asInt32, 19);
+  // 6 != 3, so the first branch jumps over an increment, then 3 < 6
+  // skips the last one.
+  EXPECT_EQ(registers[0].asInt32, 6);
+}
@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+#include "../../vm/vm.hpp"
+#include "../../vm/execution_engine.hpp"
+
+using namespace VM;
+
+// depth(n) = depth(n - 1) + 1, called far deeper than the c stack
+// would allow if every call recursed into the engine.
+TEST(Calls, deepRecursion) {
+  auto rootEnvironment = new GEnvironment();
+  auto functionEnvironment = new GEnvironment();
+  functionEnvironment->globalsCount = 1;
+  functionEnvironment->indicesInParent = { 0 };
+  functionEnvironment->localsCount = 6;
+
+  GInstruction body[] = {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 0 }},
+    GInstruction { INT_EQ, new GOPARG[3] { 0, 1, 2 }},
+    GInstruction { BRANCH, new GOPARG[3] { 2, 1, 2 }},
+    GInstruction { RETURN, new GOPARG[1] { 1 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 3, 1 }},
+    GInstruction { SUBTRACT_INT, new GOPARG[3] { 0, 3, 0 }},
+    GInstruction { GLOBAL_LOAD, new GOPARG[2] { 4, 0 }},
+    GInstruction { FUNCTION_CALL, new GOPARG[4] { 5, 4, 1, 0 }},
+    GInstruction { ADD_INT, new GOPARG[3] { 5, 3, 5 }},
+    GInstruction { RETURN, new GOPARG[1] { 5 }},
+    GInstruction { END, NULL }
+  };
+  std::vector<GValue> constants;
+  auto function = new GFunction {
+    .argumentCount = 1,
+    .environment = functionEnvironment,
+    .instructions = assembleBytecode(body, 11, constants),
+  };
+  rootEnvironment->functions.push_back(function);
+
+  GInstruction main[] = {
+    GInstruction { FUNCTION_CREATE, new GOPARG[2] { 0, 0 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 200000 }},
+    GInstruction { FUNCTION_CALL, new GOPARG[4] { 2, 0, 1, 1 }},
+    GInstruction { END, NULL }
+  };
+  auto registers = new GValue[3];
+  GEnvironmentInstance scope {
+    .environment = rootEnvironment,
+    .locals = registers
+  };
+  auto registerStack = getRegisterStack();
+  auto top = registerStack->top;
+  executeInstructions(NULL, assembleBytecode(main, 4, constants), scope);
+
+  EXPECT_EQ(registers[2].asInt32, 200000);
+  // every frame was released.
+  EXPECT_EQ(registerStack->top, top);
+}
+
+static void builtin_subtract(GValue* arguments, int argumentCount, GValue* result) {
+  EXPECT_EQ(argumentCount, 2);
+  result->asInt32 = arguments[0].asInt32 - arguments[1].asInt32;
+}
+
+TEST(Calls, builtinCall) {
+  GInstruction instructions[] = {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 10 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 2, 3 }},
+    GInstruction { BUILTIN_CALL, new GOPARG[5] { 3, 0, 2, 1, 2 }},
+    GInstruction { END, NULL }
+  };
+  std::vector<GValue> constants;
+  auto bytecode = assembleBytecode(instructions, 4, constants);
+  auto registers = new GValue[4];
+  registers[0].asBuiltin = &builtin_subtract;
+  GEnvironmentInstance scope {
+    .environment = getEmptyEnvironment(),
+    .locals = registers
+  };
+  auto top = getRegisterStack()->top;
+  executeInstructions(NULL, bytecode, scope);
+  EXPECT_EQ(registers[3].asInt32, 7);
+  // the window the arguments were passed in is released.
+  EXPECT_EQ(getRegisterStack()->top, top);
+}
+
+// the callee is taken from the constant pool, rather than a register.
+TEST(Calls, directCall) {
+  auto functionEnvironment = new GEnvironment();
+  functionEnvironment->localsCount = 3;
+  GInstruction body[] = {
+    GInstruction { SUBTRACT_INT, new GOPARG[3] { 0, 1, 2 }},
+    GInstruction { RETURN, new GOPARG[1] { 2 }},
+    GInstruction { END, NULL }
+  };
+  std::vector<GValue> functionConstants;
+  auto function = new GFunction {
+    .argumentCount = 2,
+    .environment = functionEnvironment,
+    .instructions = assembleBytecode(body, 3, functionConstants),
+    .isStatic = true,
+  };
+
+  std::vector<GValue> constants { GValue { .asRawFunction = function }};
+  GInstruction instructions[] = {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 0, 10 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 3 }},
+    GInstruction { CALL_DIRECT, new GOPARG[5] { 2, 0, 2, 0, 1 }},
+    GInstruction { END, NULL }
+  };
+  auto registers = new GValue[3];
+  GEnvironmentInstance scope {
+    .environment = getEmptyEnvironment(),
+    .locals = registers
+  };
+  executeInstructions(NULL, assembleBytecode(instructions, 4, constants), scope);
+  EXPECT_EQ(registers[2].asInt32, 7);
+}
+
+// methods get the instance they're called on as their first register.
+TEST(Calls, directMethodCall) {
+  auto classEnvironment = new GEnvironment();
+  classEnvironment->localsCount = 1;
+  classEnvironment->localsTypes.push_back(getInt32Type());
+  auto type = new GType {
+    .name = "Counter",
+    .subTypes = gstd::Array<GType*>(0),
+    .attributeCount = 1,
+    .environment = classEnvironment
+  };
+
+  auto methodEnvironment = new GEnvironment();
+  methodEnvironment->localsCount = 3;
+  GInstruction body[] = {
+    GInstruction { INSTANCE_LOAD_ATTRIBUTE, new GOPARG[3] { 2, 0, 0 }},
+    GInstruction { ADD_INT, new GOPARG[3] { 2, 1, 2 }},
+    GInstruction { INSTANCE_SET_ATTRIBUTE, new GOPARG[3] { 0, 0, 2 }},
+    GInstruction { RETURN, new GOPARG[1] { 2 }},
+    GInstruction { END, NULL }
+  };
+  std::vector<GValue> methodConstants;
+  auto method = new GFunction {
+    .argumentCount = 1,
+    .environment = methodEnvironment,
+    .instructions = assembleBytecode(body, 5, methodConstants),
+  };
+
+  std::vector<GValue> constants { GValue { .asRawFunction = method }};
+  GInstruction instructions[] = {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 5 }},
+    GInstruction { CALL_METHOD_DIRECT, new GOPARG[5] { 2, 0, 0, 1, 1 }},
+    GInstruction { CALL_METHOD_DIRECT, new GOPARG[5] { 2, 0, 0, 1, 1 }},
+    GInstruction { END, NULL }
+  };
+  auto registers = new GValue[3];
+  registers[0].asInstance = type->instantiate();
+  GEnvironmentInstance scope {
+    .environment = getEmptyEnvironment(),
+    .locals = registers
+  };
+  executeInstructions(NULL, assembleBytecode(instructions, 4, constants), scope);
+  EXPECT_EQ(registers[2].asInt32, 10);
+  EXPECT_EQ(registers[0].asInstance[0].asInt32, 10);
+}
+
+// the methods of a class are shared by its instances, and resolved
+// against the module instance the class was loaded in.
+TEST(Calls, methodTable) {
+  auto methodEnvironment = new GEnvironment();
+  methodEnvironment->globalsCount = 1;
+  methodEnvironment->indicesInParent = { 1 };
+  auto method = new GFunction { .environment = methodEnvironment };
+
+  auto classEnvironment = new GEnvironment();
+  classEnvironment->localsCount = 2;
+  classEnvironment->localsTypes = { getInt32Type(), getInt32Type() };
+  classEnvironment->functions.push_back(method);
+  auto type = new GType {
+    .name = "Pair",
+    .subTypes = gstd::Array<GType*>(0),
+    .attributeCount = 2,
+    .functionCount = 1,
+    .environment = classEnvironment
+  };
+
+  auto moduleEnvironment = new GEnvironment();
+  moduleEnvironment->isModule = true;
+  auto registers = new GValue[2];
+  GEnvironmentInstance parent {
+    .environment = moduleEnvironment,
+    .locals = registers
+  };
+  EXPECT_EQ(type->load(parent), type);
+  EXPECT_EQ(type->methods[0], method);
+  EXPECT_EQ(method->globals[0], &registers[1]);
+
+  // an instance only holds its attributes.
+  auto instance = type->instantiate();
+  EXPECT_EQ(getObjectHeader(instance)->size,
+            (int) (sizeof(GObjectHeader) + 2 * sizeof(GValue)));
+}
+
+// a class declared in a function is bound to each frame that loads it,
+// and its instances resolve their methods against that frame.
+TEST(Calls, boundMethodTable) {
+  auto methodEnvironment = new GEnvironment();
+  methodEnvironment->globalsCount = 1;
+  methodEnvironment->indicesInParent = { 0 };
+  auto method = new GFunction { .environment = methodEnvironment };
+
+  auto classEnvironment = new GEnvironment();
+  classEnvironment->localsCount = 1;
+  classEnvironment->localsTypes = { getInt32Type() };
+  classEnvironment->functions.push_back(method);
+  auto type = new GType {
+    .name = "Foo",
+    .subTypes = gstd::Array<GType*>(0),
+    .attributeCount = 1,
+    .functionCount = 1,
+    .environment = classEnvironment
+  };
+
+  auto first = new GValue[1];
+  auto second = new GValue[1];
+  GEnvironmentInstance firstFrame { .environment = getEmptyEnvironment(), .locals = first };
+  GEnvironmentInstance secondFrame { .environment = getEmptyEnvironment(), .locals = second };
+  auto firstType = type->load(firstFrame);
+  auto secondType = type->load(secondFrame);
+  EXPECT_NE(firstType, secondType);
+  EXPECT_EQ(firstType->methodGlobals[0][0], &first[0]);
+  EXPECT_EQ(secondType->methodGlobals[0][0], &second[0]);
+  // loading it again in the same frame gives the same class.
+  EXPECT_EQ(type->load(firstFrame), firstType);
+
+  auto instance = firstType->instantiate();
+  EXPECT_EQ(getObjectHeader(instance)->type, firstType);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "../../vm/vm.hpp"
+#include "../../vm/execution_engine.hpp"
+
+using namespace VM;
+
+// an environment with a register of each type.
+static GEnvironment* createEnvironment(std::vector<GType*> types) {
+  auto environment = new GEnvironment();
+  environment->localsCount = 0;
+  for (auto type : types) {
+    environment->allocateVariable(type);
+  }
+  return environment;
+}
+
+TEST(GC, headersCarryTypes) {
+  auto arrayType = getArrayType(getInt32Type());
+  auto array = allocateArray(arrayType, 3);
+  EXPECT_EQ(getObjectHeader(array)->type, arrayType);
+  EXPECT_EQ(array->elements, (GValue*) (array + 1));
+  EXPECT_EQ(getObjectHeader(allocateString(4))->type, getStringType());
+}
+
+TEST(GC, collectsUnreachableObjects) {
+  // register 0 keeps an array of strings, and register 2 gets a new
+  // array on every iteration, which is garbage by the next one.
+  auto stringArrayType = getArrayType(getStringType());
+  auto intArrayType = getArrayType(getInt32Type());
+  auto environment = createEnvironment({
+      stringArrayType, getInt32Type(), intArrayType, getStringType(), getInt32Type(), getInt32Type()
+  });
+  std::vector<GValue> constants {
+    GValue { .asType = stringArrayType }, GValue { .asType = intArrayType }
+  };
+  GInstruction instructions[] = {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 1 }},
+    GInstruction { ARRAY_ALLOCATE, new GOPARG[3] { 0, 1, 0 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 4, 0 }},
+    GInstruction { STRING_ALLOCATE, new GOPARG[2] { 3, 1 }},
+    GInstruction { ARRAY_SET_VALUE, new GOPARG[3] { 0, 4, 3 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 100 }},
+    // the loop: allocate 1000 arrays of 100 ints.
+    GInstruction { ARRAY_ALLOCATE, new GOPARG[3] { 2, 1, 1 }},
+    GInstruction { INC_INT, new GOPARG[1] { 4 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 5, 1000 }},
+    GInstruction { BRANCH_IF_LT_INT, new GOPARG[4] { 4, 5, -3, 1 }},
+    GInstruction { END, NULL }
+  };
+  auto bytecode = assembleBytecode(instructions, 11, constants);
+
+  auto registers = new GValue[environment->localsCount]();
+  GEnvironmentInstance scope {
+    .environment = environment,
+    .locals = registers
+  };
+  auto collections = getGCStats().collections;
+  auto freed = getGCStats().objectsFreed;
+  setGCThreshold(64 * 1024);
+  executeInstructions(NULL, bytecode, scope);
+  setGCThreshold(DEFAULT_GC_THRESHOLD);
+
+  EXPECT_GT(getGCStats().collections, collections);
+  EXPECT_GT(getGCStats().objectsFreed, freed);
+  EXPECT_LT(getGCStats().heapSize, 256 * 1024);
+  // the array and the string it holds survived.
+  auto kept = registers[0].asArray;
+  EXPECT_EQ(kept->size, 1);
+  EXPECT_EQ(kept->elements[0].asString->size, 1);
+  EXPECT_EQ(registers[2].asArray->size, 100);
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "../../vm/vm.hpp"
+#include "../../vm/execution_engine.hpp"
+#include "../../vm/module_cache.hpp"
+#include "../../vm/rootenvironment.hpp"
+#include "../../vm/stack.hpp"
+#include "../../vm/types/array.hpp"
+#include "../../vm/types/string.hpp"
+
+using namespace VM;
+
+// square := (n) -> n * n, called with 7, plus a float from the
+// constant pool.
+static GBytecode* createModule(GEnvironment* module) {
+  auto functionEnvironment = new GEnvironment();
+  functionEnvironment->localsCount = 2;
+  GInstruction body[] = {
+    GInstruction { MULTIPLY_INT, new GOPARG[3] { 0, 0, 1 }},
+    GInstruction { RETURN, new GOPARG[1] { 1 }},
+    GInstruction { END, NULL }
+  };
+  std::vector<GValue> functionConstants;
+  auto function = new GFunction {
+    .argumentCount = 1,
+    .environment = functionEnvironment,
+    .instructions = assembleBytecode(body, 3, functionConstants),
+    .returnType = getInt32Type()
+  };
+  module->functionsByName[gstd::intern("square")] = module->allocateFunction(function);
+  module->addObject("square", getFunctionType());
+  module->addObject("result", getInt32Type());
+  module->addObject("half", getFloatType());
+
+  std::vector<GValue> constants;
+  constants.push_back(GValue { .asFloat = 0.5 });
+  GInstruction main[] = {
+    GInstruction { FUNCTION_CREATE, new GOPARG[2] { 0, 0 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 3, 7 }},
+    GInstruction { FUNCTION_CALL, new GOPARG[4] { 1, 0, 1, 3 }},
+    GInstruction { LOAD_CONSTANT_FLOAT, new GOPARG[2] { 2, 0 }},
+    GInstruction { END, NULL }
+  };
+  module->localsCount = 4;
+  return assembleBytecode(main, 5, constants);
+}
+
+TEST(ModuleCache, roundTrip) {
+  auto path = "/tmp/test_module_cache." + std::to_string(getpid()) + ".ghc";
+  auto source = "square(7)";
+  auto key = getModuleCacheKey(source, strlen(source), 0);
+  auto compiled = new GEnvironment();
+  ASSERT_TRUE(writeModuleCache(path, key, compiled, createModule(compiled)));
+
+  // a cache is only good for the source it was compiled from.
+  auto otherKey = getModuleCacheKey("square(8)", 9, 0);
+  EXPECT_EQ(loadModuleCache(path, otherKey, new GEnvironment()), (GBytecode*) NULL);
+  auto optimizedKey = getModuleCacheKey(source, strlen(source), 1);
+  EXPECT_EQ(loadModuleCache(path, optimizedKey, new GEnvironment()), (GBytecode*) NULL);
+
+  auto module = new GEnvironment();
+  auto bytecode = loadModuleCache(path, key, module);
+  unlink(path.c_str());
+  ASSERT_NE(bytecode, (GBytecode*) NULL);
+  EXPECT_EQ(module->localsCount, 4);
+  EXPECT_EQ(module->getObject("result")->registerNum, 1);
+  EXPECT_EQ(module->localsTypes[2], getFloatType());
+  auto square = module->getFunction("square");
+  ASSERT_NE(square, (GFunction*) NULL);
+  EXPECT_EQ(square->argumentCount, 1);
+  EXPECT_EQ(square->returnType, getInt32Type());
+  EXPECT_EQ(square->environment->localsCount, 2);
+
+  auto registers = new GValue[4];
+  GEnvironmentInstance scope {
+    .environment = module,
+    .locals = registers
+  };
+  executeInstructions(NULL, bytecode, scope);
+  EXPECT_EQ(registers[1].asInt32, 49);
+  EXPECT_EQ(registers[2].asFloat, 0.5);
+}
+
+// a cache that's been changed since it was written isn't loaded.
+TEST(ModuleCache, corrupt) {
+  auto path = "/tmp/test_module_cache_corrupt." + std::to_string(getpid()) + ".ghc";
+  auto key = getModuleCacheKey("square(7)", 9, 0);
+  auto compiled = new GEnvironment();
+  ASSERT_TRUE(writeModuleCache(path, key, compiled, createModule(compiled)));
+  auto file = fopen(path.c_str(), "r+b");
+  ASSERT_NE(file, (FILE*) NULL);
+  fseek(file, -1, SEEK_END);
+  int last = fgetc(file);
+  fseek(file, -1, SEEK_END);
+  fputc(last ^ 1, file);
+  fclose(file);
+
+  EXPECT_EQ(loadModuleCache(path, key, new GEnvironment()), (GBytecode*) NULL);
+  unlink(path.c_str());
+}
+
+static GEnvironmentInstance* createRoot() {
+  auto environment = new GEnvironment();
+  environment->parent = &getBaseEnvironment();
+  return new GEnvironmentInstance { .environment = environment };
+}
+
+// count := 7, name := "ada", names := [name, name]
+TEST(ModuleCache, snapshot) {
+  auto path = "/tmp/test_snapshot." + std::to_string(getpid()) + ".ghs";
+  auto written = createRoot();
+  auto environment = written->environment;
+  environment->addObject("count", getInt32Type());
+  environment->addObject("name", getStringType());
+  environment->addObject("names", getArrayType(getStringType()));
+  written->globals = environment->resolveGlobals(getBaseEnvironmentInstance());
+  written->locals = getRegisterStack()->push(environment->localsCount);
+  auto name = createString("ada", 3);
+  auto names = allocateArray(getArrayType(getStringType()), 2);
+  names->elements[0].asString = name;
+  names->elements[1].asString = name;
+  written->locals[0].asInt32 = 7;
+  written->locals[1].asString = name;
+  written->locals[2].asArray = names;
+  ASSERT_TRUE(writeSnapshot(path, *written));
+
+  auto root = createRoot();
+  ASSERT_TRUE(loadSnapshot(path, *root));
+  unlink(path.c_str());
+  EXPECT_EQ(root->environment->getObject("names")->registerNum, 2);
+  EXPECT_EQ(root->locals[0].asInt32, 7);
+  auto loaded = root->locals[1].asString;
+  EXPECT_EQ(std::string(loaded->bytes, loaded->size), "ada");
+  EXPECT_FALSE(loaded->isConstant);
+  // objects referenced twice are still the same object.
+  auto loadedNames = root->locals[2].asArray;
+  ASSERT_EQ(loadedNames->size, 2);
+  EXPECT_EQ(loadedNames->elements[0].asString, loaded);
+  EXPECT_EQ(loadedNames->elements[1].asString, loaded);
+
+  // a module cache isn't a snapshot.
+  auto key = getModuleCacheKey("square(7)", 9, 0);
+  auto compiled = new GEnvironment();
+  ASSERT_TRUE(writeModuleCache(path, key, compiled, createModule(compiled)));
+  EXPECT_FALSE(loadSnapshot(path, *createRoot()));
+  unlink(path.c_str());
+}
+
+TEST(ModuleCache, missing) {
+  auto key = getModuleCacheKey("", 0, 0);
+  EXPECT_EQ(loadModuleCache("/tmp/does_not_exist.ghc", key, new GEnvironment()),
+            (GBytecode*) NULL);
+  EXPECT_EQ(getModuleCachePath("examples/hello.gh"), "examples/hello.ghc");
+}
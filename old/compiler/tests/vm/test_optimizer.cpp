@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "../../vm/vm.hpp"
+#include "../../vm/execution_engine.hpp"
+#include "../../codegen/passes.hpp"
+#include "../../codegen/label.hpp"
+
+using namespace VM;
+using namespace codegen;
+
+static GEnvironment* createEnvironment(int variables, int temporaries) {
+  auto environment = new GEnvironment();
+  environment->localsCount = 0;
+  for (int i = 0; i < variables; i++) {
+    environment->allocateVariable(getInt32Type());
+  }
+  for (int i = 0; i < temporaries; i++) {
+    environment->allocateObject(getInt32Type());
+  }
+  return environment;
+}
+
+TEST(Optimizer, foldConstants) {
+  GInstructions instructions {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 3 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 2, 4 }},
+    GInstruction { MULTIPLY_INT, new GOPARG[3] { 1, 2, 3 }},
+    GInstruction { INT_EQ, new GOPARG[3] { 3, 2, 4 }},
+    GInstruction { BRANCH, new GOPARG[3] { 4, 1, 2 }},
+    GInstruction { END, NULL }
+  };
+  foldConstants(instructions);
+
+  EXPECT_EQ(instructions[2].op, LOAD_CONSTANT_INT);
+  EXPECT_EQ(instructions[2].args[1].asInt32, 12);
+  EXPECT_EQ(instructions[3].op, LOAD_CONSTANT_BOOL);
+  EXPECT_FALSE(instructions[3].args[1].asBool);
+  // the branch always goes to its false target, two ahead.
+  EXPECT_EQ(instructions[4].op, GO);
+  EXPECT_EQ(instructions[4].args[0].positionDiff, 2);
+}
+
+TEST(Optimizer, copiesAndDeadStores) {
+  // x := 1 + y; print(x), with x and y variables 0 and 1.
+  auto environment = createEnvironment(2, 3);
+  GInstructions instructions {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 2, 1 }},
+    GInstruction { SET, new GOPARG[2] { 1, 3 }},
+    GInstruction { ADD_INT, new GOPARG[3] { 2, 3, 4 }},
+    GInstruction { SET, new GOPARG[2] { 4, 0 }},
+    GInstruction { PRINT_INT, new GOPARG[1] { 0 }},
+    GInstruction { END, NULL }
+  };
+  propagateCopies(environment, instructions);
+  eliminateDeadStores(environment, instructions);
+
+  ASSERT_EQ(instructions.size(), 4);
+  EXPECT_EQ(instructions[1].op, ADD_INT);
+  EXPECT_EQ(instructions[1].args[1].registerNum, 1);
+  EXPECT_EQ(instructions[1].args[2].registerNum, 0);
+  EXPECT_EQ(instructions[2].op, PRINT_INT);
+}
+
+TEST(Optimizer, variablesAreKept) {
+  // stores to variables stay, even if the body never reads them.
+  auto environment = createEnvironment(1, 1);
+  GInstructions instructions {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 5 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 0, 5 }},
+    GInstruction { END, NULL }
+  };
+  eliminateDeadStores(environment, instructions);
+
+  ASSERT_EQ(instructions.size(), 2);
+  EXPECT_EQ(instructions[0].args[0].registerNum, 0);
+}
+
+TEST(Optimizer, threadJumps) {
+  GInstructions instructions {
+    GInstruction { BRANCH, new GOPARG[3] { 0, 1, 2 }},
+    GInstruction { GO, new GOPARG[1] { 1 }},
+    GInstruction { GO, new GOPARG[1] { 2 }},
+    GInstruction { PRINT_INT, new GOPARG[1] { 0 }},
+    GInstruction { GO, new GOPARG[1] { 1 }},
+    GInstruction { END, NULL }
+  };
+  threadJumps(instructions);
+
+  // the chain of GOs collapses into a jump straight to the END, and
+  // the GO to the next instruction goes away.
+  ASSERT_EQ(instructions.size(), 5);
+  EXPECT_EQ(instructions[0].args[1].positionDiff, 4);
+  EXPECT_EQ(instructions[0].args[2].positionDiff, 4);
+  EXPECT_EQ(instructions[3].op, PRINT_INT);
+  EXPECT_EQ(instructions[4].op, END);
+}
+
+TEST(Optimizer, allocateRegisters) {
+  // x := (1 + 2) + (3 + 4), with x variable 0 and the rest temporaries.
+  auto environment = createEnvironment(1, 6);
+  GInstructions instructions {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 1 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 2, 2 }},
+    GInstruction { ADD_INT, new GOPARG[3] { 1, 2, 3 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 4, 3 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 5, 4 }},
+    GInstruction { ADD_INT, new GOPARG[3] { 4, 5, 6 }},
+    GInstruction { ADD_INT, new GOPARG[3] { 3, 6, 0 }},
+    GInstruction { END, NULL }
+  };
+  allocateRegisters(environment, instructions);
+
+  // the temporaries of the second sum reuse the registers of the
+  // first's operands. a result never shares a register with the
+  // operands it's computed from.
+  EXPECT_EQ(environment->localsCount, 5);
+  EXPECT_EQ(environment->localsTemporary.size(), 5);
+  EXPECT_EQ(instructions[6].args[2].registerNum, 0);
+
+  auto bytecode = assembleBytecode(&instructions[0], instructions.size(),
+                                   environment->constants);
+  auto registers = new GValue[environment->localsCount];
+  GEnvironmentInstance scope {
+    .environment = environment,
+    .locals = registers
+  };
+  executeInstructions(NULL, bytecode, scope);
+  EXPECT_EQ(registers[0].asInt32, 10);
+}
+
+// copies are propagated into variables, and superinstructions formed,
+// then the result is run with x and y (variables 0 and 1) set.
+static GValue* optimizeAndRun(GEnvironment* environment, GInstructions& instructions,
+                              int x, int y) {
+  propagateCopies(environment, instructions);
+  fuseInstructions(environment, instructions);
+  auto bytecode = assembleBytecode(&instructions[0], instructions.size(),
+                                   environment->constants);
+  auto registers = new GValue[environment->localsCount]();
+  registers[0].asInt32 = x;
+  registers[1].asInt32 = y;
+  GEnvironmentInstance scope {
+    .environment = environment,
+    .locals = registers
+  };
+  executeInstructions(NULL, bytecode, scope);
+  return registers;
+}
+
+// variables can be read by nested functions as globals, so their
+// stores stay even when the body only reads them once.
+TEST(Optimizer, fusedConstantIsStillStored) {
+  // c := 1; d := x + c, with x, c and d variables 0, 2 and 3.
+  auto environment = createEnvironment(4, 2);
+  GInstructions instructions {
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 4, 1 }},
+    GInstruction { SET, new GOPARG[2] { 4, 2 }},
+    GInstruction { ADD_INT, new GOPARG[3] { 0, 2, 5 }},
+    GInstruction { SET, new GOPARG[2] { 5, 3 }},
+    GInstruction { END, NULL }
+  };
+  auto registers = optimizeAndRun(environment, instructions, 5, 0);
+  EXPECT_EQ(instructions[0].op, LOAD_CONST_ADD);
+  EXPECT_EQ(registers[2].asInt32, 1);
+  EXPECT_EQ(registers[3].asInt32, 6);
+}
+
+TEST(Optimizer, fusedCompareIsStillStored) {
+  // b := x < y; if b: z := 1, with b and z variables 2 and 3.
+  auto environment = createEnvironment(4, 2);
+  GInstructions instructions {
+    GInstruction { LESS_THAN_INT, new GOPARG[3] { 0, 1, 4 }},
+    GInstruction { SET, new GOPARG[2] { 4, 2 }},
+    GInstruction { BRANCH, new GOPARG[3] { 2, 1, 2 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 3, 1 }},
+    GInstruction { END, NULL }
+  };
+  auto registers = optimizeAndRun(environment, instructions, 1, 2);
+  EXPECT_EQ(instructions[1].op, BRANCH);
+  EXPECT_TRUE(registers[2].asBool);
+  EXPECT_EQ(registers[3].asInt32, 1);
+}
+
+// jumps to a label are relative to the jump, whether they're emitted
+// before the label is bound or after.
+TEST(Codegen, labels) {
+  GInstructions instructions;
+  GLabel start, end;
+  start.bind(instructions);
+  instructions.push_back(GInstruction { LOAD_CONSTANT_BOOL, new GOPARG[2] { 0, 1 }});
+  instructions.push_back(GInstruction { BRANCH, new GOPARG[3] { 0, 1, 0 }});
+  end.addJump(instructions, 2);
+  instructions.push_back(GInstruction { GO, new GOPARG[1] { 0 }});
+  start.addJump(instructions, 0);
+  end.bind(instructions);
+  instructions.push_back(GInstruction { END, NULL });
+
+  EXPECT_EQ(instructions[1].args[2].positionDiff, 2);
+  EXPECT_EQ(instructions[2].args[0].positionDiff, -2);
+}
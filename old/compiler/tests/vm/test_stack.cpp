@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include "../../vm/stack.hpp"
+
+using namespace VM;
+
+TEST(RegisterStack, framesAreContiguous) {
+  auto stack = getRegisterStack();
+  auto first = stack->push(3);
+  auto second = stack->push(2);
+  EXPECT_EQ(second, first + 3);
+  EXPECT_EQ(stack->top, first + 5);
+
+  stack->pop(2);
+  stack->pop(3);
+  EXPECT_EQ(stack->top, first);
+}
+
+TEST(RegisterStack, framesAreZeroed) {
+  auto stack = getRegisterStack();
+  auto frame = stack->push(2);
+  frame[0].asInt32 = 10;
+  frame[1].asInt32 = 20;
+  stack->pop(2);
+
+  frame = stack->push(2);
+  EXPECT_EQ(frame[0].asInt32, 0);
+  EXPECT_EQ(frame[1].asInt32, 0);
+  stack->pop(2);
+}
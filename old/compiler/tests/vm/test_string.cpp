@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include "../../vm/vm.hpp"
+#include "../../vm/execution_engine.hpp"
+
+using namespace VM;
+
+TEST(String, bytesAreContiguous) {
+  auto string = createString("hello", 5);
+  EXPECT_EQ(string->size, 5);
+  EXPECT_EQ(string->bytes, (char*) (string + 1));
+  EXPECT_EQ(strncmp(string->bytes, "hello", 5), 0);
+}
+
+TEST(String, stringOps) {
+  std::vector<GValue> constants { GValue { .asString = internString("barbaz") }};
+  GInstruction instructions[] = {
+    GInstruction { LOAD_CONSTANT_STRING, new GOPARG[2] { 0, 0 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 0 }},
+    GInstruction { LOAD_CONSTANT_CHAR, new GOPARG[2] { 2, { .asChar = 'c' }}},
+    GInstruction { STRING_SET_CHAR, new GOPARG[3] { 0, 1, 2 }},
+    GInstruction { STRING_LOAD_LENGTH, new GOPARG[2] { 0, 3 }},
+    GInstruction { LOAD_CONSTANT_INT, new GOPARG[2] { 1, 3 }},
+    GInstruction { STRING_LOAD_CHAR, new GOPARG[3] { 0, 1, 4 }},
+    GInstruction { END, NULL }
+  };
+  auto bytecode = assembleBytecode(instructions, 8, constants);
+
+  auto registers = new GValue[5];
+  GEnvironmentInstance scope {
+    .environment = getEmptyEnvironment(),
+    .locals = registers
+  };
+  executeInstructions(NULL, bytecode, scope);
+  EXPECT_EQ(strncmp(registers[0].asString->bytes, "carbaz", 6), 0);
+  // the literal itself doesn't change.
+  EXPECT_NE(registers[0].asString, constants[0].asString);
+  EXPECT_EQ(strncmp(constants[0].asString->bytes, "barbaz", 6), 0);
+  EXPECT_EQ(registers[3].asInt32, 6);
+  EXPECT_EQ(registers[4].asChar, 'b');
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "../../vm/vm.hpp"
+#include "../../std/gstd.hpp"
+
+using namespace VM;
+
+TEST(Symbols, intern) {
+  gstd::SymbolTable symbols;
+  auto foo = symbols.intern("foo");
+  auto bar = symbols.intern("bar");
+  EXPECT_NE(foo, bar);
+  // the same text is the same symbol, wherever it's read from.
+  const char* source = "x = foo";
+  EXPECT_EQ(symbols.intern(source + 4, 3), foo);
+  EXPECT_EQ(symbols.name(bar), "bar");
+
+  // symbols survive the table growing.
+  for (int i = 0; i < 5000; i++) {
+    symbols.intern("name" + std::to_string(i));
+  }
+  EXPECT_EQ(symbols.intern("foo"), foo);
+  EXPECT_EQ(symbols.intern("name1234"), symbols.intern("name1234"));
+  EXPECT_EQ(symbols.size(), 5002);
+}
+
+TEST(Symbols, map) {
+  gstd::SymbolMap<int> map;
+  EXPECT_EQ(map.find(3), (int*) NULL);
+  for (int i = 0; i < 100; i++) {
+    map[i * 7] = i;
+  }
+  EXPECT_EQ(map.size(), 100);
+  EXPECT_EQ(*map.find(70), 10);
+  EXPECT_FALSE(map.contains(71));
+
+  map[70] = -1;
+  EXPECT_EQ(map.size(), 100);
+  EXPECT_EQ(*map.find(70), -1);
+
+  // entries come back in the order they were added.
+  int i = 0;
+  for (auto& kv : map) {
+    EXPECT_EQ(kv.first, i * 7);
+    i++;
+  }
+
+  auto copy = map;
+  copy[1] = 1;
+  EXPECT_TRUE(copy.contains(1));
+  EXPECT_FALSE(map.contains(1));
+}
+
+// names a function doesn't declare are brought in from the scope it's
+// declared in when they're first used, rather than all copied up front.
+TEST(Symbols, importObject) {
+  auto parent = new GEnvironment();
+  parent->addObject("x", getInt32Type());
+  parent->addObject("y", getBoolType());
+  auto child = new GEnvironment();
+  child->parent = parent;
+  EXPECT_EQ(child->globalsCount, 0);
+
+  auto y = child->importObject(gstd::intern("y"));
+  EXPECT_EQ(y->indexType, GLOBAL);
+  EXPECT_EQ(y->registerNum, 0);
+  EXPECT_EQ(y->type, getBoolType());
+  EXPECT_EQ(child->indicesInParent[0], 1);
+  EXPECT_EQ(child->importObject(gstd::intern("y"))->registerNum, 0);
+  EXPECT_EQ(child->importObject(gstd::intern("z")), (GIndex*) NULL);
+  EXPECT_EQ(child->globalsCount, 1);
+
+  // globals of the parent are found through its globals.
+  auto grandchild = new GEnvironment();
+  grandchild->parent = child;
+  grandchild->importObject(gstd::intern("x"));
+  EXPECT_EQ(child->indicesInParent[1], 0);
+  EXPECT_EQ(grandchild->indicesInParent[0], -2);
+}
@@ -6,79 +6,55 @@
 // we'll need to do an if/else for windows at
 // some point.
 #include <unistd.h>
+#include <algorithm>
 
 namespace VM {
 
-  void addBuiltinRead(GEnvironment* environment) {
-    environment->addFunction("read", new GFunction {
-        .argumentCount = 3,
-        .argumentTypes = new GType*[3]{
-          getInt32Type(),
-          getStringType(),
-          getInt32Type()
-        },
-        .returnType = getInt32Type(),
-        .isNative = true,
-    });
-    environment->localsTypes[environment->localsCount - 1] = getBuiltinType();
-  }
-
-  // None __builtin__.read(fd Int, buffer Array<char>, size Int)
-  GValue* builtin_read(GValue* args) {
+  // Int __builtin__.read(fd Int, buffer String, size Int)
+  // reads straight into the bytes of the buffer, up to its size.
+  void builtin_read(GValue* args, int, GValue* result) {
     int fd = args[0].asInt32;
-    GValue* buffer = args[1].asArray->elements;
-    int size = args[2].asInt32;
-
-    // TODO: this is really messy. this
-    // should use the buffer directly at some point
-    // in the future.
-    char inBuf[size];
-    int bytesRead = read(fd, &inBuf, size);
-
-    for (int i = 0; i < size; i++) {
-      buffer[i].asChar = inBuf[i];
-    }
-
-    return new GValue { bytesRead };
-  }
+    auto buffer = args[1].asString;
+    int size = std::min(args[2].asInt32, buffer->size);
 
-  void addBuiltinWrite(GEnvironment* environment) {
-    environment->addFunction("write", new GFunction {
-        .argumentCount = 3,
-        .argumentTypes = new GType*[3]{
-          getInt32Type(),
-          getStringType(),
-          getInt32Type()
-        },
-        .returnType = getNoneType(),
-        .isNative = true
-    });
-    environment->localsTypes[environment->localsCount - 1] = getBuiltinType();
+    result->asInt32 = read(fd, buffer->bytes, size);
   }
 
-  GValue* builtin_write(GValue* args) {
+  // None __builtin__.write(fd Int, buffer String, size Int)
+  void builtin_write(GValue* args, int, GValue*) {
     // TODO: this should return the integer value.
     int fd = args[0].asInt32;
-    GValue* buffer = (GValue*) args[1].asArray->elements;
-    int size = args[2].asInt32;
+    auto buffer = args[1].asString;
+    int size = std::min(args[2].asInt32, buffer->size);
 
-    // TODO: this is really messy. this
-    // should use the buffer directly at some point
-    // in the future.
-    char inBuf[size];
-
-    for (int i = 0; i < size; i++) {
-      inBuf[i] = buffer[i].asChar;
-    }
-
-    write(fd, &inBuf, size);
+    write(fd, buffer->bytes, size);
+  }
 
-    return getNoneObject();
+  std::vector<GBuiltin>& getBuiltinTable() {
+    auto static builtins = new std::vector<GBuiltin> {
+      {"read", &builtin_read, { getInt32Type(), getStringType(), getInt32Type() },
+       getInt32Type()},
+      {"write", &builtin_write, { getInt32Type(), getStringType(), getInt32Type() },
+       getNoneType()},
+    };
+    return *builtins;
   }
 
-  /* std::map<std::string, Builtin> builtinMap = {
-    {"read", builtin_read}
-    }; */
+  // builtins are functions to codegen, but their registers hold a
+  // Builtin rather than a function instance.
+  static void addBuiltin(GEnvironment* environment, GBuiltin& builtin) {
+    int argumentCount = builtin.argumentTypes.size();
+    auto function = new GFunction {
+      .argumentCount = argumentCount,
+      .argumentTypes = new GType*[argumentCount],
+      .returnType = builtin.returnType,
+      .isNative = true
+    };
+    std::copy(builtin.argumentTypes.begin(), builtin.argumentTypes.end(),
+              function->argumentTypes);
+    environment->functionsByName[gstd::intern(builtin.name)] = environment->allocateFunction(function);
+    environment->addObject(builtin.name, getBuiltinType());
+  }
 
   GType* getBuiltinModuleType() {
     auto static _initialized = false;
@@ -88,8 +64,9 @@ namespace VM {
       .environment = builtinEnv
     };
     if (!_initialized) {
-      addBuiltinRead(builtinEnv);
-      addBuiltinWrite(builtinEnv);
+      for (auto& builtin : getBuiltinTable()) {
+        addBuiltin(builtinEnv, builtin);
+      }
       _initialized = true;
     }
     return builtinType;
@@ -100,8 +77,11 @@ namespace VM {
     auto static environment =                                         \
       getBuiltinModuleType()->environment->createInstance(getEmptyEnvironmentInstance());
     if (!_initialized) {
-      environment->locals[0].asBuiltin = &builtin_read;
-      environment->locals[1].asBuiltin = &builtin_write;
+      auto& builtins = getBuiltinTable();
+      for (int i = 0; i < (int) builtins.size(); i++) {
+        auto index = environment->environment->getObject(builtins[i].name);
+        environment->locals[index->registerNum].asBuiltin = builtins[i].function;
+      }
       _initialized = true;
     }
     return environment;
@@ -10,10 +10,19 @@
 #define VM_BUILTINS_HPP
 
 namespace VM {
-  extern std::map<std::string, Builtin> builtinMap;
-  extern std::vector<Builtin> builtinList;
 
-  GValue* builtin_read(GValue* args);
+  // an entry of the __builtins__ module.
+  typedef struct GBuiltin {
+    std::string name;
+    Builtin* function;
+    std::vector<GType*> argumentTypes;
+    GType* returnType;
+  } GBuiltin;
+
+  std::vector<GBuiltin>& getBuiltinTable();
+
+  void builtin_read(GValue* args, int argumentCount, GValue* result);
+  void builtin_write(GValue* args, int argumentCount, GValue* result);
   GType* getBuiltinModuleType();
   GEnvironmentInstance* getBuiltins();
 }
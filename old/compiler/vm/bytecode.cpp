@@ -0,0 +1,135 @@
+#include "bytecode.hpp"
+#include <string.h>
+
+namespace VM {
+
+  const GOPINFO& getOpInfo(GOPCODE op) {
+    static GOPINFO opInfo[GOPCODE_COUNT];
+    static bool _initialized = false;
+    if (!_initialized) {
+      opInfo[ADD_INT] = { "ADD_INT", "rrw" };
+      opInfo[ADD_FLOAT] = { "ADD_FLOAT", "rrw" };
+      opInfo[ADD_INT_IMM] = { "ADD_INT_IMM", "riw" };
+      opInfo[ARRAY_ALLOCATE] = { "ARRAY_ALLOCATE", "wrk" };
+      opInfo[ARRAY_SET_VALUE] = { "ARRAY_SET_VALUE", "rrr" };
+      opInfo[ARRAY_LOAD_VALUE] = { "ARRAY_LOAD_VALUE", "rrw" };
+      opInfo[ARRAY_LOAD_LENGTH] = { "ARRAY_LOAD_LENGTH", "rw" };
+      opInfo[BOOL_PRINT] = { "BOOL_PRINT", "r" };
+      opInfo[BRANCH] = { "BRANCH", "rjj" };
+      opInfo[BRANCH_IF_EQ_INT] = { "BRANCH_IF_EQ_INT", "rrjj" };
+      opInfo[BRANCH_IF_LT_INT] = { "BRANCH_IF_LT_INT", "rrjj" };
+      opInfo[BUILTIN_CALL] = { "BUILTIN_CALL", "wrn" };
+      opInfo[CALL_DIRECT] = { "CALL_DIRECT", "wkn" };
+      opInfo[CALL_METHOD_DIRECT] = { "CALL_METHOD_DIRECT", "wrkn" };
+      opInfo[CHAR_EQ] = { "CHAR_EQ", "rrw" };
+      opInfo[DIVIDE_FLOAT] = { "DIVIDE_FLOAT", "rrw" };
+      opInfo[DIVIDE_INT] = { "DIVIDE_INT", "rrw" };
+      opInfo[END] = { "END", "" };
+      opInfo[FILEHANDLE_WRITE] = { "FILEHANDLE_WRITE", "rr" };
+      opInfo[FLOAT_EQ] = { "FLOAT_EQ", "rrw" };
+      opInfo[FUNCTION_CREATE] = { "FUNCTION_CREATE", "wi" };
+      opInfo[FUNCTION_CALL] = { "FUNCTION_CALL", "wrn" };
+      opInfo[GO] = { "GO", "j" };
+      opInfo[GLOBAL_LOAD] = { "GLOBAL_LOAD", "wi" };
+      opInfo[GLOBAL_SET] = { "GLOBAL_SET", "ir" };
+      opInfo[INC_INT] = { "INC_INT", "x" };
+      opInfo[INSTANCE_CREATE] = { "INSTANCE_CREATE", "wrn" };
+      opInfo[INSTANCE_LOAD_ATTRIBUTE] = { "INSTANCE_LOAD_ATTRIBUTE", "wri" };
+      opInfo[INSTANCE_SET_ATTRIBUTE] = { "INSTANCE_SET_ATTRIBUTE", "rir" };
+      opInfo[INT_TO_FLOAT] = { "INT_TO_FLOAT", "rw" };
+      opInfo[INT_EQ] = { "INT_EQ", "rrw" };
+      opInfo[INT_OR] = { "INT_OR", "rrw" };
+      opInfo[LOAD_CONST_ADD] = { "LOAD_CONST_ADD", "wirw" };
+      opInfo[LOAD_CONSTANT_BOOL] = { "LOAD_CONSTANT_BOOL", "wi" };
+      opInfo[LOAD_CONSTANT_CHAR] = { "LOAD_CONSTANT_CHAR", "wi" };
+      opInfo[LOAD_CONSTANT_FLOAT] = { "LOAD_CONSTANT_FLOAT", "wk" };
+      opInfo[LOAD_CONSTANT_INT] = { "LOAD_CONSTANT_INT", "wi" };
+      opInfo[LOAD_CONSTANT_STRING] = { "LOAD_CONSTANT_STRING", "wk" };
+      opInfo[LOAD_MODULE] = { "LOAD_MODULE", "wk" };
+      opInfo[LESS_THAN_INT] = { "LESS_THAN_INT", "rrw" };
+      opInfo[MULTIPLY_FLOAT] = { "MULTIPLY_FLOAT", "rrw" };
+      opInfo[MULTIPLY_INT] = { "MULTIPLY_INT", "rrw" };
+      opInfo[PRIMITIVE_METHOD_CALL] = { "PRIMITIVE_METHOD_CALL", "wrk" };
+      opInfo[PRINT_CHAR] = { "PRINT_CHAR", "r" };
+      opInfo[PRINT_FLOAT] = { "PRINT_FLOAT", "r" };
+      opInfo[PRINT_INT] = { "PRINT_INT", "r" };
+      opInfo[PRINT_STRING] = { "PRINT_STRING", "r" };
+      opInfo[SET] = { "SET", "rw" };
+      opInfo[STRING_ALLOCATE] = { "STRING_ALLOCATE", "wr" };
+      opInfo[STRING_COPY] = { "STRING_COPY", "rw" };
+      opInfo[STRING_LOAD_CHAR] = { "STRING_LOAD_CHAR", "rrw" };
+      opInfo[STRING_LOAD_LENGTH] = { "STRING_LOAD_LENGTH", "rw" };
+      opInfo[STRING_SET_CHAR] = { "STRING_SET_CHAR", "xrr" };
+      opInfo[SUBTRACT_FLOAT] = { "SUBTRACT_FLOAT", "rrw" };
+      opInfo[SUBTRACT_INT] = { "SUBTRACT_INT", "rrw" };
+      opInfo[TYPE_LOAD] = { "TYPE_LOAD", "wi" };
+      opInfo[RETURN] = { "RETURN", "r" };
+      opInfo[RETURN_NONE] = { "RETURN_NONE", "" };
+      _initialized = true;
+    }
+    return opInfo[op];
+  }
+
+  // the size of an instruction, given its operands. the count of a
+  // variable length instruction is the operand right after
+  // the fixed ones.
+  int getInstructionSize(GOPCODE op, GOPARG* operands) {
+    auto kinds = getOpInfo(op).operands;
+    int fixedCount = strlen(kinds);
+    if (fixedCount > 0 && kinds[fixedCount - 1] == 'n') {
+      return 1 + fixedCount + operands[fixedCount - 1].size;
+    }
+    return 1 + fixedCount;
+  }
+
+  int getInstructionSize(GOPARG* instruction) {
+    return getInstructionSize(getOpcode(*instruction), instruction + 1);
+  }
+
+  GBytecode* assembleBytecode(GInstruction* instructions, int count,
+                              std::vector<GValue>& constants) {
+    // first pass: find where every instruction starts. we need one
+    // more, for jumps to the end of the body.
+    auto offsets = new int[count + 1];
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+      offsets[i] = size;
+      size += getInstructionSize(instructions[i].op, instructions[i].args);
+    }
+    offsets[count] = size;
+
+    // second pass: copy everything over, translating jumps from
+    // instructions to words.
+    auto code = new GOPARG[size];
+    for (int i = 0; i < count; i++) {
+      auto& instruction = instructions[i];
+      auto word = code + offsets[i];
+      auto kinds = getOpInfo(instruction.op).operands;
+      word[0].op = instruction.op;
+
+      int operandCount = getInstructionSize(instruction.op, instruction.args) - 1;
+      for (int j = 0; j < operandCount; j++) {
+        auto operand = instruction.args[j];
+        if (j < (int) strlen(kinds) && kinds[j] == 'j') {
+          operand.positionDiff = offsets[i + operand.positionDiff] - offsets[i];
+        }
+        word[1 + j] = operand;
+      }
+    }
+    delete[] offsets;
+
+    auto constantsCount = (int) constants.size();
+    auto constantPool = new GValue[constantsCount];
+    for (int i = 0; i < constantsCount; i++) {
+      constantPool[i] = constants[i];
+    }
+
+    return new GBytecode {
+      .code = code,
+      .size = size,
+      .constants = constantPool,
+      .constantsCount = constantsCount,
+      .linked = false
+    };
+  }
+}
@@ -0,0 +1,71 @@
+#include <vector>
+#include "object.hpp"
+#include "ops.hpp"
+
+#ifndef VM_BYTECODE_HPP
+#define VM_BYTECODE_HPP
+
+namespace VM {
+
+  /*
+    the packed instruction stream executed by the vm.
+
+    codegen works on GInstructions (an opcode plus a heap allocated
+    array of operands), which are easy to build and patch. once a body
+    is complete, it's assembled into a GBytecode: every instruction is
+    laid out back to back, as an opcode word followed directly by its
+    operands, each one word (4 bytes) wide.
+
+    values that don't fit in an operand (floats, strings) are moved
+    into the constant pool of the body, and referenced by index.
+
+    the opcode word stores the GOPCODE in the low OPCODE_BITS. the
+    remaining bits are free for the execution engine to use (threaded
+    dispatch stores the offset of the handler there).
+   */
+  const int OPCODE_BITS = 8;
+  const int OPCODE_MASK = (1 << OPCODE_BITS) - 1;
+
+  typedef struct GBytecode {
+    GOPARG* code;
+    // in words
+    int size;
+    GValue* constants;
+    int constantsCount;
+    // set by the execution engine, once it has prepared code for
+    // execution.
+    bool linked;
+  } GBytecode;
+
+  /*
+    the operands an opcode expects, one character per operand:
+
+    w: a register written to
+    r: a register read from
+    x: a register read from, then written to
+    i: an immediate value (an int, a char, a bool, or an index into
+       one of the tables of the environment)
+    k: an index into the constant pool
+    j: a jump, relative to the start of the instruction
+    n: the number of registers read that follow. must be last.
+   */
+  typedef struct {
+    const char* name;
+    const char* operands;
+  } GOPINFO;
+
+  const GOPINFO& getOpInfo(GOPCODE op);
+
+  inline GOPCODE getOpcode(GOPARG word) {
+    return (GOPCODE) (word.op & OPCODE_MASK);
+  }
+
+  // the size of the instruction starting at instruction, in words.
+  int getInstructionSize(GOPARG* instruction);
+  int getInstructionSize(GOPCODE op, GOPARG* operands);
+
+  GBytecode* assembleBytecode(GInstruction* instructions, int count,
+                              std::vector<GValue>& constants);
+}
+
+#endif
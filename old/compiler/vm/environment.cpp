@@ -11,31 +11,40 @@
 namespace VM {
 
   // object methods
-  GIndex* GEnvironment::addObject(std::string name, GType* type) {
-    auto index = allocateObject(type);
+  GIndex* GEnvironment::addObject(gstd::Symbol name, GType* type) {
+    auto index = allocateVariable(type);
     localsByName[name] = index->registerNum;
     return index;
   }
 
   GIndex* GEnvironment::allocateObject(GType* type) {
     localsTypes.push_back(type);
+    localsTemporary.push_back(true);
     return new GIndex {
       .registerNum = localsCount++,
       .type = type
     };
   }
 
-  GIndex* GEnvironment::getObject(std::string name) {
-    if (localsByName.find(name) != localsByName.end()) {
-      int index = localsByName[name];
+  // a variable that isn't accessible by name through the
+  // environment, such as one declared in a nested block.
+  GIndex* GEnvironment::allocateVariable(GType* type) {
+    auto index = allocateObject(type);
+    localsTemporary[index->registerNum] = false;
+    return index;
+  }
+
+  GIndex* GEnvironment::getObject(gstd::Symbol name) {
+    if (auto local = localsByName.find(name)) {
+      int index = *local;
       return new GIndex {
         .registerNum = index,
         .type = localsTypes[index]
       };
     }
 
-    if (globalsByName.find(name) != globalsByName.end()) {
-      int index = globalsByName[name];
+    if (auto global = globalsByName.find(name)) {
+      int index = *global;
       return new GIndex {
         .indexType = GLOBAL,
         .registerNum = index,
@@ -46,13 +55,34 @@ namespace VM {
     return NULL;
   }
 
+  GIndex* GEnvironment::importObject(gstd::Symbol name) {
+    auto index = getObject(name);
+    if (index != NULL || parent == NULL) {
+      return index;
+    }
+    index = parent->importObject(name);
+    return index == NULL ? NULL : addGlobal(name, index);
+  }
+
+  GIndex* GEnvironment::addGlobal(gstd::Symbol name, GIndex* index) {
+    indicesInParent.push_back(index->indexType == GLOBAL ?
+                              -(index->registerNum + 1) : index->registerNum);
+    globalsTypes.push_back(index->type);
+    globalsByName[name] = globalsCount;
+    return new GIndex {
+      .indexType = GLOBAL,
+      .registerNum = globalsCount++,
+      .type = index->type
+    };
+  }
+
   // class methods
   int GEnvironment::allocateClass(GType* cls) {
     classes.push_back(cls);
     return classesCount++;
   }
 
-  GIndex* GEnvironment::addClass(std::string name, VM::GType* cls) {
+  GIndex* GEnvironment::addClass(gstd::Symbol name, VM::GType* cls) {
     auto classIndex = allocateClass(cls);
     classesByName[name] = classIndex;
     return new GIndex {
@@ -61,15 +91,15 @@ namespace VM {
     };
   }
 
-  GType* GEnvironment::getClass(std::string name) {
-    if (classesByName.find(name) != classesByName.end()) {
-      return classes[classesByName[name]];
+  GType* GEnvironment::getClass(gstd::Symbol name) {
+    if (auto cls = classesByName.find(name)) {
+      return classes[*cls];
     }
     return NULL;
   }
 
   // function methods
-  GIndex* GEnvironment::addFunction(std::string name, GFunction* func) {
+  GIndex* GEnvironment::addFunction(gstd::Symbol name, GFunction* func) {
     int functionIndex = allocateFunction(func);
     debug(functionIndex);
     functionsByName[name] = functionIndex;
@@ -82,17 +112,25 @@ namespace VM {
     return functionsCount++;
   }
 
-  GFunction* GEnvironment::getFunction(std::string name) {
-    if (functionsByName.find(name) != functionsByName.end()) {
-      return functions[functionsByName[name]];
+  GFunction* GEnvironment::getFunction(gstd::Symbol name) {
+    if (auto function = functionsByName.find(name)) {
+      return functions[*function];
     }
     return NULL;
   }
 
+  // constant methods
+  int GEnvironment::addConstant(GValue value) {
+    constants.push_back(value);
+    return constants.size() - 1;
+  }
 
-  GEnvironmentInstance* GEnvironment::createInstance(GEnvironmentInstance& parent) {
-    auto globals = new GValue*[globalsCount];
+  GValue** GEnvironment::resolveGlobals(GEnvironmentInstance& parent) {
+    return resolveGlobals(parent, new GValue*[globalsCount]);
+  }
 
+  // fills in globals, which must have room for globalsCount pointers.
+  GValue** GEnvironment::resolveGlobals(GEnvironmentInstance& parent, GValue** globals) {
     for (int i = 0; i < globalsCount; i++) {
       auto index = indicesInParent[i];
       bool globalValue = index < 0;
@@ -102,10 +140,13 @@ namespace VM {
         globals[i] = &(parent.locals[index]);
       }
     }
+    return globals;
+  }
 
+  GEnvironmentInstance* GEnvironment::createInstance(GEnvironmentInstance& parent) {
     return new GEnvironmentInstance {
       .environment = this,
-      .globals = globals,
+      .globals = resolveGlobals(parent),
       .locals = new GValue[localsCount]
     };
   }
@@ -4,6 +4,7 @@
 #include "ops.hpp"
 #include "type.hpp"
 #include "object.hpp"
+#include "../std/gstd.hpp"
 
 #ifndef VM_CONTEXT_HPP
 #define VM_CONTEXT_HPP
@@ -14,46 +15,86 @@ namespace VM {
   struct GFunction;
 
   typedef std::map<std::string, GType*> GTypeMap;
+  // the register, function or class each name refers to.
+  typedef gstd::SymbolMap<int> GSymbolTable;
 
   // we use a class instead of a struct
   // so we can encapsulate things for now,
   // until a good mechanism is decided.
   class GEnvironment {
   public:
+    // the environment instances of this one are created in. its names
+    // are brought in as globals when they're first looked up.
+    GEnvironment* parent;
+
     // globals data
-    std::map<std::string, int> globalsByName;
-    GType** globalsTypes;
-    int* indicesInParent;
+    GSymbolTable globalsByName;
+    std::vector<GType*> globalsTypes;
+    // where each global lives in the parent instance: a register, or
+    // -(n + 1) for the parent's global n.
+    std::vector<int> indicesInParent;
     int globalsCount;
 
     // function data
-    std::map<std::string, int> functionsByName;
+    GSymbolTable functionsByName;
     std::vector<GFunction*> functions;
     int functionsCount;
 
     // class data
-    std::map<std::string, int> classesByName;
+    GSymbolTable classesByName;
     std::vector<GType*> classes;
     int classesCount;
 
     // locals data
-    std::map<std::string, int> localsByName;
+    GSymbolTable localsByName;
     std::vector<GType*> localsTypes;
+    // whether each local is a temporary: an intermediate value only
+    // the code of the environment reads, rather than a variable.
+    std::vector<bool> localsTemporary;
     int localsCount;
 
-    GIndex*     addObject(std::string name, GType* type);
+    // constant pool data
+    std::vector<GValue> constants;
+
+    // whether this is the environment of a module, which only ever
+    // has a single instance.
+    bool isModule;
+
+    GIndex*     addObject(gstd::Symbol name, GType* type);
     GIndex*     allocateObject(GType* type);
-    GIndex*     getObject(std::string name);
+    GIndex*     allocateVariable(GType* type);
+    GIndex*     getObject(gstd::Symbol name);
+    // like getObject, but looks in the parent if it isn't found.
+    GIndex*     importObject(gstd::Symbol name);
+    // a global referring to index, of the parent.
+    GIndex*     addGlobal(gstd::Symbol name, GIndex* index);
 
-    GIndex*     addClass(std::string name, GType* type);
+    GIndex*     addClass(gstd::Symbol name, GType* type);
     int         allocateClass(GType* type);
-    GType*      getClass(std::string name);
+    GType*      getClass(gstd::Symbol name);
 
-    GIndex*     addFunction(std::string name, GFunction* func);
+    GIndex*     addFunction(gstd::Symbol name, GFunction* func);
     int         allocateFunction(GFunction* func);
-    GFunction*  getFunction(std::string name);
+    GFunction*  getFunction(gstd::Symbol name);
+
+    // for names that don't come from the tokenizer, like builtins.
+    GIndex*     addObject(const std::string& name, GType* type) {
+      return addObject(gstd::intern(name), type);
+    }
+    GIndex*     getObject(const std::string& name) {
+      return getObject(gstd::intern(name));
+    }
+    GFunction*  getFunction(const std::string& name) {
+      return getFunction(gstd::intern(name));
+    }
+
+    int         addConstant(GValue value);
 
 
+    // the globals table of an instance: pointers to the registers
+    // of parent each global refers to.
+    GValue**    resolveGlobals(GEnvironmentInstance& parent);
+    GValue**    resolveGlobals(GEnvironmentInstance& parent, GValue** globals);
     GEnvironmentInstance* createInstance(GEnvironmentInstance&);
     GEnvironment* createChild();
   };
@@ -15,6 +15,14 @@ namespace VM {
     virtual ~CodeGenException() throw() {}
   };
 
+  // raised when the vm is unable to continue running a program.
+  class VMException: public std::exception {
+  public:
+    const std::string message;
+    VMException(std::string _message) : message(_message) {}
+    virtual ~VMException() throw() {}
+  };
+
 }
 
 #endif
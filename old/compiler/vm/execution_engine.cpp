@@ -1,4 +1,6 @@
 #include "execution_engine.hpp"
+#include "exception.hpp"
+#include <stdint.h>
 #include <string.h>
 #include <string>
 #include <iostream>
@@ -9,343 +11,636 @@
 #define debug(s);
 #endif
 
+/*
+  the engine can dispatch instructions in one of two ways:
+
+  * by default, a portable switch over the opcode inside a loop.
+  * with THREADED_DISPATCH (make DISPATCH=threaded), direct threaded
+    code: the first time a body runs, the offset of the handler of
+    every instruction (a label, via the computed goto extension
+    supported by gcc and clang) is stored in the free bits of its
+    opcode word, and each handler jumps straight to the handler of the
+    next instruction. offsets are from the lowest handler, so they're
+    never negative.
+
+  the handlers themselves are shared between both modes, through the
+  OP / NEXT / JUMP macros below. NEXT takes the number of operands of
+  the instruction, to step over them.
+
+  calls between greyhawk functions don't recurse into the engine:
+  FUNCTION_CALL pushes a GCallFrame on the register stack and jumps to
+  the start of the callee, and returning pops it and jumps back. so
+  the depth of recursion is only limited by the size of the register
+  stack.
+
+  when the callee is known when compiling, CALL_DIRECT and
+  CALL_METHOD_DIRECT take the GFunction from the constant pool
+  instead, along with the globals it was resolved with, or for a
+  method, that the class of the instance was bound to. methods are
+  passed the instance they're called on in their first register.
+ */
+#ifdef THREADED_DISPATCH
+#define OP(name) L_##name
+#define DISPATCH() args = pc + 1; goto *(handlerBase + ((unsigned) pc->op >> OPCODE_BITS));
+#define HANDLER(name) labels[name] = &&L_##name
+#define LINK(b) if (!(b)->linked) { linkBytecode(b, handlers); }
+#else
+#define OP(name) case name
+#define DISPATCH() break
+#define LINK(b)
+#endif
+#define NEXT(operands) pc += 1 + (operands); DISPATCH()
+#define JUMP(diff) pc += (diff); DISPATCH()
+
+// instructions that allocate collect first, when it's time to. every
+// value alive is in a register at that point, and the activation
+// knows which call is running.
+#define SAFEPOINT()                              \
+  if (shouldCollectGarbage()) {                  \
+    collectGarbage();                            \
+  }
+
+// push the frame of a call to func, which returns past the current
+// instruction (of size operands). its registers are left zeroed.
+#define PUSH_FRAME(func, functionGlobals, operands)                     \
+  auto frameSize = CALL_FRAME_SIZE + (func)->environment->localsCount;  \
+  auto callFrame = (GCallFrame*) registerStack->push(frameSize);        \
+  callFrame->previous = frame;                                          \
+  callFrame->size = frameSize;                                          \
+  callFrame->returnBytecode = bytecode;                                 \
+  callFrame->returnPc = pc + 1 + (operands);                            \
+  callFrame->returnRegister = args[0].registerNum;                      \
+  callFrame->instance = GEnvironmentInstance {                          \
+    .environment = (func)->environment,                                 \
+    .globals = (functionGlobals),                                       \
+    .locals = (GValue*) callFrame + CALL_FRAME_SIZE                     \
+  };
+
+// jump to the start of func, in the frame just pushed.
+#define ENTER_FRAME(func)                               \
+  frame = callFrame;                                    \
+  activation.frame = frame;                             \
+  ENTER(&callFrame->instance, (func)->instructions);    \
+  pc = bytecode->code;                                  \
+  DISPATCH();
+
+// switch to running code against instance.
+#define ENTER(inst, code)                        \
+  instance = (inst);                             \
+  locals = instance->locals;                     \
+  globals = instance->globals;                   \
+  environment = instance->environment;           \
+  bytecode = (code);                             \
+  constants = bytecode->constants;               \
+  LINK(bytecode)
+
 namespace VM {
 
-  GValue executeInstructions(GModules* modules, GInstruction* instructions, GEnvironmentInstance& environmentInstance) {
+#ifdef THREADED_DISPATCH
+  // store the offset of the handler of every instruction in its
+  // opcode word.
+  void linkBytecode(GBytecode* bytecode, unsigned* handlers) {
+    auto end = bytecode->code + bytecode->size;
+    for (auto word = bytecode->code; word < end; word += getInstructionSize(word)) {
+      auto op = getOpcode(*word);
+      word->op = (int) ((unsigned) op | (handlers[op] << OPCODE_BITS));
+    }
+    bytecode->linked = true;
+  }
+#endif
+
+  // registers the registers of an invocation of the engine as roots,
+  // for as long as it runs.
+  class GActivationScope {
+  public:
+    GActivationScope(GActivation& activation) : activation(activation) {
+      activation.previous = getCurrentActivation();
+      getCurrentActivation() = &activation;
+    }
+    ~GActivationScope() {
+      getCurrentActivation() = activation.previous;
+    }
+  private:
+    GActivation& activation;
+  };
+
+  GValue executeInstructions(GModules* modules, GBytecode* bytecode, GEnvironmentInstance& environmentInstance) {
+    auto instance = &environmentInstance;
     auto locals = environmentInstance.locals;
     auto globals = environmentInstance.globals;
     auto environment = environmentInstance.environment;
-    auto instruction = instructions;
+    auto constants = bytecode->constants;
+    auto registerStack = getRegisterStack();
+    auto pc = bytecode->code;
+    // the call currently running, or NULL when we're still in the
+    // code the engine was invoked with.
+    GCallFrame* frame = NULL;
+    GValue returnValue;
+    GActivation activation { .instance = &environmentInstance };
+    GActivationScope activationScope(activation);
     // for debugging purposes
     debug("Environment:");
     debug("  globals:");
     for (auto& kv: environment->globalsByName) {
-      debug("    name: " << kv.first << " register: " << kv.second);
+      debug("    name: " << gstd::symbolName(kv.first) << " register: " << kv.second);
     }
 
+#ifdef THREADED_DISPATCH
+    static unsigned handlers[GOPCODE_COUNT];
+    static char* handlerBase;
+    static bool _initialized = false;
+    if (!_initialized) {
+      void* labels[GOPCODE_COUNT] = {};
+      HANDLER(ADD_INT);
+      HANDLER(ADD_FLOAT);
+      HANDLER(ADD_INT_IMM);
+      HANDLER(ARRAY_ALLOCATE);
+      HANDLER(ARRAY_SET_VALUE);
+      HANDLER(ARRAY_LOAD_VALUE);
+      HANDLER(ARRAY_LOAD_LENGTH);
+      HANDLER(BOOL_PRINT);
+      HANDLER(BRANCH);
+      HANDLER(BRANCH_IF_EQ_INT);
+      HANDLER(BRANCH_IF_LT_INT);
+      HANDLER(BUILTIN_CALL);
+      HANDLER(CALL_DIRECT);
+      HANDLER(CALL_METHOD_DIRECT);
+      HANDLER(CHAR_EQ);
+      HANDLER(DIVIDE_FLOAT);
+      HANDLER(DIVIDE_INT);
+      HANDLER(END);
+      HANDLER(FILEHANDLE_WRITE);
+      HANDLER(FLOAT_EQ);
+      HANDLER(FUNCTION_CREATE);
+      HANDLER(FUNCTION_CALL);
+      HANDLER(GO);
+      HANDLER(GLOBAL_LOAD);
+      HANDLER(GLOBAL_SET);
+      HANDLER(INC_INT);
+      HANDLER(INSTANCE_CREATE);
+      HANDLER(INSTANCE_LOAD_ATTRIBUTE);
+      HANDLER(INSTANCE_SET_ATTRIBUTE);
+      HANDLER(INT_TO_FLOAT);
+      HANDLER(INT_EQ);
+      HANDLER(INT_OR);
+      HANDLER(LOAD_CONST_ADD);
+      HANDLER(LOAD_CONSTANT_BOOL);
+      HANDLER(LOAD_CONSTANT_CHAR);
+      HANDLER(LOAD_CONSTANT_FLOAT);
+      HANDLER(LOAD_CONSTANT_INT);
+      HANDLER(LOAD_CONSTANT_STRING);
+      HANDLER(LOAD_MODULE);
+      HANDLER(LESS_THAN_INT);
+      HANDLER(MULTIPLY_FLOAT);
+      HANDLER(MULTIPLY_INT);
+      HANDLER(PRIMITIVE_METHOD_CALL);
+      HANDLER(PRINT_CHAR);
+      HANDLER(PRINT_FLOAT);
+      HANDLER(PRINT_INT);
+      HANDLER(PRINT_STRING);
+      HANDLER(SET);
+      HANDLER(STRING_ALLOCATE);
+      HANDLER(STRING_COPY);
+      HANDLER(STRING_LOAD_CHAR);
+      HANDLER(STRING_LOAD_LENGTH);
+      HANDLER(STRING_SET_CHAR);
+      HANDLER(SUBTRACT_FLOAT);
+      HANDLER(SUBTRACT_INT);
+      HANDLER(TYPE_LOAD);
+      HANDLER(RETURN);
+      HANDLER(RETURN_NONE);
+      auto base = UINTPTR_MAX;
+      for (auto label : labels) {
+        if (label != NULL && (uintptr_t) label < base) {
+          base = (uintptr_t) label;
+        }
+      }
+      for (int op = 0; op < GOPCODE_COUNT; op++) {
+        auto offset = labels[op] == NULL ? 0 : (uintptr_t) labels[op] - base;
+        // the offset has to fit the free bits of an int opcode word.
+        if (offset >= (uintptr_t) 1 << (31 - OPCODE_BITS)) {
+          throw VMException("the handlers of the execution engine are too far apart");
+        }
+        handlers[op] = offset;
+      }
+      handlerBase = (char*) base;
+      _initialized = true;
+    }
+
+    // link the body on its first run.
+    LINK(bytecode);
+
+    GOPARG* args;
+    DISPATCH();
+#else
     // the actual logic
     bool done = false;
     while (!done) {
-      auto args = instruction->args;
+      auto args = pc + 1;
 
-      switch (instruction->op) {
+      switch (getOpcode(*pc)) {
+#endif
 
-      case ARRAY_ALLOCATE: {
+      OP(ARRAY_ALLOCATE): {
+        SAFEPOINT();
         auto arraySize = locals[args[1].registerNum].asInt32;
         debug("ARRAY_ALLOCATE: " << arraySize);
         locals[args[0].registerNum].asArray =
-          new GArray{ new GValue[arraySize], arraySize};
+          allocateArray(constants[args[2].constantIndex].asType, arraySize);
       }
-        break;
+        NEXT(3);
 
-      case ARRAY_SET_VALUE:
+      OP(ARRAY_SET_VALUE):
         debug("ARRAY_SET_VALUE")
         locals[args[0].registerNum].asArray->elements[locals[args[1].registerNum].asInt32] =
           locals[args[2].registerNum];
-        break;
+        NEXT(3);
 
-      case ARRAY_LOAD_VALUE:
+      OP(ARRAY_LOAD_VALUE):
         debug("ARRAY_LOAD_VALUE")
         locals[args[2].registerNum] =
           locals[args[0].registerNum].asArray->elements[locals[args[1].registerNum].asInt32];
-        break;
+        NEXT(3);
 
-      case ARRAY_LOAD_LENGTH:
+      OP(ARRAY_LOAD_LENGTH):
         locals[args[1].registerNum].asInt32 =
           locals[args[0].registerNum].asArray->size;
-        break;
+        NEXT(2);
 
-      case ADD_INT:
+      OP(ADD_INT):
         locals[args[2].registerNum].asInt32 =
           locals[args[0].registerNum].asInt32 + locals[args[1].registerNum].asInt32;
-        break;
+        NEXT(3);
+
+      OP(ADD_INT_IMM):
+        locals[args[2].registerNum].asInt32 =
+          locals[args[0].registerNum].asInt32 + args[1].asInt32;
+        NEXT(3);
 
-      case ADD_FLOAT:
+      OP(ADD_FLOAT):
         // addFloat(instruction->values[0], instruction->values[1], instruction->values[2]);
-        break;
+        NEXT(3);
 
-      case BRANCH:
+      OP(BRANCH):
         if (locals[args[0].registerNum].asBool) {
-          instruction += args[1].positionDiff - 1;
+          JUMP(args[1].positionDiff);
         } else {
-          instruction += args[2].positionDiff - 1;
+          JUMP(args[2].positionDiff);
         }
-        break;
 
-      case BUILTIN_CALL: {
+      OP(BRANCH_IF_EQ_INT):
+        if (locals[args[0].registerNum].asInt32 ==
+            locals[args[1].registerNum].asInt32) {
+          JUMP(args[2].positionDiff);
+        } else {
+          JUMP(args[3].positionDiff);
+        }
+
+      OP(BRANCH_IF_LT_INT):
+        if (locals[args[0].registerNum].asInt32 <
+            locals[args[1].registerNum].asInt32) {
+          JUMP(args[2].positionDiff);
+        } else {
+          JUMP(args[3].positionDiff);
+        }
+
+      OP(BUILTIN_CALL): {
         debug("BUILTIN_CALL")
         auto builtin = locals[args[1].registerNum].asBuiltin;
-        int argCount = 3;
-        auto arguments = new GValue[3];
+        int argCount = args[2].size;
+        // the arguments are passed in a window of registers, right past
+        // the top of the stack.
+        auto arguments = registerStack->push(argCount);
 
         for (int i = 0; i < argCount; i++) {
-          // we start at argument 2 on, because 0 and 1 are the return
-          // value register and the function register, respectively.
-          arguments[i] = locals[args[2 + i].registerNum];
+          // we start at argument 3 on, because 0, 1 and 2 are the
+          // return value register, the function register and the
+          // argument count, respectively.
+          arguments[i] = locals[args[3 + i].registerNum];
         }
 
         debug("BUILTIN_CALL: executing...")
-        auto value = (*builtin)(arguments);
-        if (value != NULL) {
-          locals[args[0].registerNum] = *value;
-          // delete value;
-        }
+        (*builtin)(arguments, argCount, &locals[args[0].registerNum]);
+        registerStack->pop(argCount);
         debug("BUILTIN_CALL: finished...")
-        break;
+        NEXT(3 + argCount);
       }
 
-      case BOOL_PRINT: {
+      OP(BOOL_PRINT): {
         debug("BOOL_PRINT");
         printf("%s\n", locals[args[0].registerNum].asBool ? "true" : "false");
-        break;
+        NEXT(1);
+      }
+
+      OP(CALL_DIRECT): {
+        auto func = constants[args[1].constantIndex].asRawFunction;
+        PUSH_FRAME(func, func->globals, 3 + args[2].size);
+        for (int i = 0; i < args[2].size; i++) {
+          callFrame->instance.locals[i] = locals[args[3 + i].registerNum];
+        }
+        ENTER_FRAME(func);
+      }
+
+      OP(CALL_METHOD_DIRECT): {
+        auto func = constants[args[2].constantIndex].asRawFunction;
+        // the instance's class is bound to the frame that loaded it,
+        // when it was declared in a function.
+        auto type = getObjectHeader(locals[args[1].registerNum].asInstance)->type;
+        auto methodGlobals = type->methodGlobals == NULL ?
+          func->globals : type->methodGlobals[func->methodIndex];
+        PUSH_FRAME(func, methodGlobals, 4 + args[3].size);
+        // the instance goes first, then the arguments.
+        callFrame->instance.locals[0] = locals[args[1].registerNum];
+        for (int i = 0; i < args[3].size; i++) {
+          callFrame->instance.locals[1 + i] = locals[args[4 + i].registerNum];
+        }
+        ENTER_FRAME(func);
       }
 
-      case CHAR_EQ:
+      OP(CHAR_EQ):
         locals[args[2].registerNum].asBool =
           locals[args[0].registerNum].asChar ==
           locals[args[1].registerNum].asChar;
-        break;
+        NEXT(3);
 
-      case TYPE_LOAD:
-        locals[args[0].registerNum].asType = environment->classes[args[1].registerNum];
-        locals[args[0].registerNum].asType->parentEnv = &environmentInstance;
-        break;
+      OP(TYPE_LOAD):
+        locals[args[0].registerNum].asType =
+          environment->classes[args[1].registerNum]->load(*instance);
+        NEXT(2);
 
-      case DIVIDE_FLOAT:
+      OP(DIVIDE_FLOAT):
         locals[args[2].registerNum].asFloat =
           locals[args[0].registerNum].asFloat /
           locals[args[1].registerNum].asFloat;
-        break;
+        NEXT(3);
 
-      case DIVIDE_INT:
+      OP(DIVIDE_INT):
         locals[args[2].registerNum].asInt32 =
           locals[args[0].registerNum].asInt32 /
           locals[args[1].registerNum].asInt32;
-        break;
+        NEXT(3);
 
-      case END:
-        return { 0 };
-        break;
 
-      case FILEHANDLE_WRITE: {
+      OP(FILEHANDLE_WRITE): {
         auto file = locals[args[0].registerNum].asFile;
-        auto str = locals[args[1].registerNum].asArray;
-        auto elements = str->elements;
-        for (int i = 0; i < str->size; i++) {
-          fprintf(file, "%c", elements[i].asChar);
-        }
-        break;
+        auto str = locals[args[1].registerNum].asString;
+        fwrite(str->bytes, 1, str->size, file);
+        NEXT(2);
       }
 
-      case FLOAT_EQ:
+      OP(FLOAT_EQ):
         locals[args[2].registerNum].asBool =
           locals[args[0].registerNum].asFloat ==
           locals[args[1].registerNum].asFloat;
+        NEXT(3);
 
-      case FUNCTION_CREATE: {
+      OP(FUNCTION_CREATE): {
+        SAFEPOINT();
         auto function = environment->functions[args[1].registerNum];
+        if (function->isStatic && function->globals == NULL) {
+          function->globals = function->environment->resolveGlobals(*instance);
+        }
         locals[args[0].registerNum].asFunction = \
-          function->createInstance(environmentInstance);
-        break;
+          function->createInstance(*instance);
+        NEXT(2);
       }
 
-      case FUNCTION_CALL: {
+      OP(FUNCTION_CALL): {
         debug("FUNCTION_CALL: start " << args[1].registerNum);
         auto funcInst = locals[args[1].registerNum].asFunction;
-        debug("FUNCTION_CALL: generating register num");
         auto func = funcInst->function;
-        debug("FUNCTION_CALL: generating env instance");
-        auto funcEnvInstance = func->environment->createInstance(funcInst->parentEnv);
-
-        for (int i = 0; i < func->argumentCount; i++) {
-          // we start at argument 2 on, because 0 and 1 are the return
-          // value register and the function register, respectively.
-          funcEnvInstance->locals[i] = locals[args[2 + i].registerNum];
+        debug("FUNCTION_CALL: pushing frame");
+        PUSH_FRAME(func, funcInst->getGlobals(), 3 + args[2].size);
+
+        for (int i = 0; i < args[2].size; i++) {
+          // we start at argument 3 on, because 0, 1 and 2 are the
+          // return value register, the function register and the
+          // argument count, respectively.
+          callFrame->instance.locals[i] = locals[args[3 + i].registerNum];
         }
 
         debug("FUNCTION_CALL: execute")
-        locals[args[0].registerNum] = executeInstructions(modules,
-                                                         func->instructions,
-                                                         *funcEnvInstance);
-        delete funcEnvInstance->locals;
-        delete funcEnvInstance->globals;
-        delete funcEnvInstance;
-        break;
+        ENTER_FRAME(func);
       }
 
-      case GO:
-        instruction += args[0].positionDiff - 1;
-        break;
+      OP(GO):
+        JUMP(args[0].positionDiff);
 
       // GLOBAL METHODS
 
-      case GLOBAL_LOAD: {
+      OP(GLOBAL_LOAD): {
         debug("GLOBAL_LOAD")
         locals[args[0].registerNum] = *(globals[args[1].registerNum]);
-        break;
+        NEXT(2);
       }
 
-      case GLOBAL_SET:
+      OP(GLOBAL_SET):
         *(globals[args[0].registerNum]) = locals[args[1].registerNum];
-        break;
+        NEXT(2);
 
       // INSTANCE METHODS
 
-      case INSTANCE_CREATE: {
+      OP(INSTANCE_CREATE): {
+        SAFEPOINT();
         auto type = locals[args[1].registerNum].asType;
         auto instance = type->instantiate();
-        for (int i = 0; i < type->attributeCount; i++) {
-          instance->locals[i] = locals[args[i + 2].registerNum];
+        for (int i = 0; i < args[2].size; i++) {
+          instance[i] = locals[args[i + 3].registerNum];
         }
         locals[args[0].registerNum].asInstance = instance;
-        break;
+        NEXT(3 + args[2].size);
       }
 
-      case INSTANCE_LOAD_ATTRIBUTE:
+      OP(INSTANCE_LOAD_ATTRIBUTE):
         debug("INSTANCE_LOAD_ATTRIBUTE")
         debug(locals)
         debug(locals[args[1].registerNum].asInstance)
         locals[args[0].registerNum] =                                 \
-          locals[args[1].registerNum].asInstance->locals[args[2].registerNum];
+          locals[args[1].registerNum].asInstance[args[2].registerNum];
         debug("finished loading attribute")
-        break;
+        NEXT(3);
 
-      case INSTANCE_SET_ATTRIBUTE:
-        locals[args[0].registerNum].asInstance->locals[args[1].registerNum] = \
+      OP(INSTANCE_SET_ATTRIBUTE):
+        locals[args[0].registerNum].asInstance[args[1].registerNum] = \
           locals[args[2].registerNum];
-        break;
+        NEXT(3);
+
+      OP(INC_INT):
+        locals[args[0].registerNum].asInt32++;
+        NEXT(1);
 
-      case INT_EQ:
+      OP(INT_EQ):
         locals[args[2].registerNum].asBool =
           locals[args[0].registerNum].asInt32 ==
           locals[args[1].registerNum].asInt32;
-        break;
+        NEXT(3);
 
-      case INT_TO_FLOAT:
+      OP(INT_TO_FLOAT):
         // intToFloat(instruction->values[0], instruction->values[1]);
-        break;
+        NEXT(2);
 
-      case INT_OR:
+      OP(INT_OR):
         locals[args[2].registerNum].asInt32 =
           locals[args[0].registerNum].asInt32 |
           locals[args[1].registerNum].asInt32;
-        break;
+        NEXT(3);
 
-      case LOAD_CONSTANT_BOOL:
+      OP(LOAD_CONST_ADD):
+        locals[args[0].registerNum].asInt32 = args[1].asInt32;
+        locals[args[3].registerNum].asInt32 =
+          locals[args[2].registerNum].asInt32 + args[1].asInt32;
+        NEXT(4);
+
+      OP(LOAD_CONSTANT_BOOL):
         locals[args[0].registerNum].asBool = args[1].asBool;
-        break;
+        NEXT(2);
 
-      case LOAD_CONSTANT_CHAR:
+      OP(LOAD_CONSTANT_CHAR):
         locals[args[0].registerNum].asChar = args[1].asChar;
-        break;
+        NEXT(2);
 
-      case LOAD_CONSTANT_FLOAT:
-        locals[args[0].registerNum].asFloat = args[1].asFloat;
-        break;
+      OP(LOAD_CONSTANT_FLOAT):
+        locals[args[0].registerNum].asFloat = constants[args[1].constantIndex].asFloat;
+        NEXT(2);
 
-      case LOAD_CONSTANT_INT:
+      OP(LOAD_CONSTANT_INT):
         debug("LOAD_CONSTANT_INT");
         locals[args[0].registerNum].asInt32 = args[1].asInt32;
-        break;
+        NEXT(2);
 
-      case LOAD_CONSTANT_STRING: {
+      OP(LOAD_CONSTANT_STRING): {
         debug("LOAD_CONSTANT_STRING");
-        auto constantString = args[1].asString;
-        auto length = (int) strlen(constantString);
-        auto elements = new GValue[length];
-        for (int i = 0; i < length; i++) {
-          elements[i].asChar = constantString[i];
-        }
-        locals[args[0].registerNum].asArray =
-          new GArray { .elements = elements, .size = length };
-        break;
+        locals[args[0].registerNum] = constants[args[1].constantIndex];
+        NEXT(2);
       }
 
-      case LOAD_MODULE: {
-        auto moduleName = args[1].asString;
+      OP(LOAD_MODULE): {
+        auto moduleName = constants[args[1].constantIndex].asCString;
         locals[args[0].registerNum].asModule = (*modules)[moduleName];
-        break;
+        NEXT(2);
       }
 
-      case LESS_THAN_INT:
+      OP(LESS_THAN_INT):
         locals[args[2].registerNum].asBool =
           locals[args[0].registerNum].asInt32 <
           locals[args[1].registerNum].asInt32;
-        break;
+        NEXT(3);
 
-      case MULTIPLY_FLOAT:
+      OP(MULTIPLY_FLOAT):
         locals[args[2].registerNum].asFloat =
           locals[args[0].registerNum].asFloat *
           locals[args[1].registerNum].asFloat;
-        break;
+        NEXT(3);
 
-      case MULTIPLY_INT:
+      OP(MULTIPLY_INT):
         locals[args[2].registerNum].asInt32 =
           locals[args[0].registerNum].asInt32 *
           locals[args[1].registerNum].asInt32;
-        break;
+        NEXT(3);
 
-      case PRIMITIVE_METHOD_CALL: {
+      // the method is resolved by codegen. primitive methods don't
+      // take arguments yet.
+      OP(PRIMITIVE_METHOD_CALL): {
         debug("PRIMITIVE_METHOD_CALL");
-        int argCount = 0;
-        auto arguments = new GValue[0];
-
-        for (int i = 0; i < argCount; i++) {
-          // we start at argument 2 on, because 0 and 1 are the return
-          // value register and the function register, respectively.
-          arguments[i] = locals[args[4 + i].registerNum];
-        }
-
-        auto primitiveMethod = primitives[args[2].asString][args[3].asString].rawMethod;
+        auto primitiveMethod = constants[args[2].constantIndex].asPrimitiveMethod;
         locals[args[0].registerNum] =
-          (*primitiveMethod)(locals[args[1].registerNum], arguments);
-        break;
+          (*primitiveMethod)(locals[args[1].registerNum], NULL);
+        NEXT(3);
       }
 
-      case PRINT_CHAR:
+      OP(PRINT_CHAR):
         printf("%c\n", locals[args[0].registerNum].asChar);
-        break;
+        NEXT(1);
 
-      case PRINT_FLOAT:
+      OP(PRINT_FLOAT):
         printf("%f\n", locals[args[0].registerNum].asFloat);
-        break;
+        NEXT(1);
 
-      case PRINT_INT:
+      OP(PRINT_INT):
         printf("%d\n", locals[args[0].registerNum].asInt32);
-        break;
+        NEXT(1);
 
-      case PRINT_STRING: {
-        auto str = locals[args[0].registerNum].asArray;
-        auto elements = str->elements;
-        for (int i = 0; i < str->size; i++) {
-          printf("%c", elements[i].asChar);
-        }
-        printf("\n");
-        break;
+      OP(PRINT_STRING): {
+        auto str = locals[args[0].registerNum].asString;
+        fwrite(str->bytes, 1, str->size, stdout);
+        putchar('\n');
+        NEXT(1);
       }
 
-      case RETURN:
-        return locals[instruction->args[0].registerNum];
+      OP(RETURN):
+        returnValue = locals[args[0].registerNum];
+        goto finishCall;
 
-      case RETURN_NONE:
-        return { 0 };
+      OP(RETURN_NONE):
+      OP(END):
+        returnValue = { 0 };
+        goto finishCall;
 
-      case SET:
+      OP(SET):
         debug("SET");
         locals[args[1].registerNum] = locals[args[0].registerNum];
-        break;
+        NEXT(2);
 
-      case SUBTRACT_INT:
+      OP(SUBTRACT_INT):
         locals[args[2].registerNum].asInt32 =
           locals[args[0].registerNum].asInt32 -
           locals[args[1].registerNum].asInt32;
-        break;
+        NEXT(3);
+
+      OP(STRING_ALLOCATE):
+        SAFEPOINT();
+        locals[args[0].registerNum].asString =
+          allocateString(locals[args[1].registerNum].asInt32);
+        NEXT(2);
+
+      OP(STRING_COPY): {
+        SAFEPOINT();
+        auto str = locals[args[0].registerNum].asString;
+        locals[args[1].registerNum].asString = createString(str->bytes, str->size);
+        NEXT(2);
+      }
+
+      OP(STRING_LOAD_CHAR):
+        locals[args[2].registerNum].asChar =
+          locals[args[0].registerNum].asString->bytes[locals[args[1].registerNum].asInt32];
+        NEXT(3);
+
+      OP(STRING_LOAD_LENGTH):
+        locals[args[1].registerNum].asInt32 =
+          locals[args[0].registerNum].asString->size;
+        NEXT(2);
+
+      OP(STRING_SET_CHAR): {
+        SAFEPOINT();
+        auto str = getMutableString(locals[args[0].registerNum].asString);
+        locals[args[0].registerNum].asString = str;
+        str->bytes[locals[args[1].registerNum].asInt32] = locals[args[2].registerNum].asChar;
+        NEXT(3);
+      }
+
+      OP(SUBTRACT_FLOAT):
+        NEXT(3);
 
-      case SUBTRACT_FLOAT:
+      finishCall: {
+        if (frame == NULL) {
+          return returnValue;
+        }
+        auto finished = frame;
+        frame = finished->previous;
+        activation.frame = frame;
+        ENTER(frame == NULL ? &environmentInstance : &frame->instance,
+              finished->returnBytecode);
+        locals[finished->returnRegister] = returnValue;
+        registerStack->pop(finished->size);
+        pc = finished->returnPc;
+        DISPATCH();
+      }
+#ifndef THREADED_DISPATCH
+      default:
         break;
       }
-      instruction++;
     }
+#endif
     return GValue { .asBool = false };
   }
 }
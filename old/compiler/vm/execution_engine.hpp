@@ -1,5 +1,10 @@
+#include "bytecode.hpp"
 #include "function.hpp"
+#include "gc.hpp"
+#include "stack.hpp"
+#include "types/array.hpp"
 #include "types/primitives.hpp"
+#include "types/string.hpp"
 #include <map>
 
 #ifndef VM2_EXECUTIONENGINE_HPP
@@ -7,7 +12,7 @@
 
 namespace VM {
 
-  GValue executeInstructions(GModules*, GInstruction*, GEnvironmentInstance&);
+  GValue executeInstructions(GModules*, GBytecode*, GEnvironmentInstance&);
 }
 
 
@@ -2,9 +2,9 @@
 
 namespace VM {
 
-  GIndex* GFrame::getGlobal(std::string name) {
-    if (globalsTable.find(name) != globalsTable.end()) {
-      int index = globalsTable[name];
+  GIndex* GFrame::getGlobal(gstd::Symbol name) {
+    if (auto global = globalsTable.find(name)) {
+      int index = *global;
       return new GIndex {
         .indexType = GLOBAL,
         .registerNum = index,
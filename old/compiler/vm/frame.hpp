@@ -11,13 +11,13 @@ namespace VM {
   class GFrame {
   public:
     // globals
-    std::map<std::string, int> globalsTable;
+    gstd::SymbolMap<int> globalsTable;
     GType** globalsTypes;
     int* indicesInParent;
     int globalsCount;
 
     // function data
-    std::map<std::string, GFunction*> functionByName;
+    gstd::SymbolMap<GFunction*> functionByName;
     std::map<int, int> functionTable;
     std::vector<GFunction*> functions;
     int functionCount;
@@ -27,7 +27,7 @@ namespace VM {
     std::vector<GType*> localsTypes;
     int localsCount;
 
-    GIndex* getGlobal(std::string name);
+    GIndex* getGlobal(gstd::Symbol name);
     GIndex* allocateObject(GType* type);
   };
 }
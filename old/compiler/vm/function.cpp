@@ -1,12 +1,22 @@
 #include "function.hpp"
 #include "execution_engine.hpp"
+#include "gc.hpp"
+#include <new>
 
 namespace VM {
 
   GFunctionInstance* GFunction::createInstance(GEnvironmentInstance& parentEnvironment) {
-    return new GFunctionInstance {
+    auto memory = gcAllocate(getFunctionType(), sizeof(GFunctionInstance));
+    return new (memory) GFunctionInstance {
       .function = this,
       .parentEnv = parentEnvironment
     };
   }
+
+  GValue** GFunctionInstance::getGlobals() {
+    if (globals == NULL) {
+      globals = function->environment->resolveGlobals(parentEnv);
+    }
+    return globals;
+  }
 }
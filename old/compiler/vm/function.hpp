@@ -1,3 +1,4 @@
+#include "bytecode.hpp"
 #include "environment.hpp"
 #include <map>
 
@@ -16,9 +17,18 @@ namespace VM {
     std::string*  argumentNames;
     GType**       argumentTypes;
     GEnvironment*  environment;
-    GInstruction* instructions;
+    GBytecode*    instructions;
     GType*        returnType;
     bool          isNative;
+    // functions declared in a module are only ever bound to its single
+    // instance, so they can be called directly, rather than through a
+    // function object.
+    bool          isStatic;
+    // for static functions and methods: the globals table, resolved
+    // when the function is created, or when its class is loaded.
+    GValue**      globals;
+    // for methods: their place in the method table of their class.
+    int           methodIndex;
 
     GFunctionInstance* createInstance(GEnvironmentInstance&);
   } GFunction;
@@ -27,6 +37,11 @@ namespace VM {
   public:
     GFunction* function;
     GEnvironmentInstance& parentEnv;
+    // the globals table of the function, resolved against parentEnv
+    // the first time the function is called.
+    GValue** globals;
+
+    GValue** getGlobals();
   };
 
 }
@@ -0,0 +1,203 @@
+#include "gc.hpp"
+#include "builtins.hpp"
+#include "function.hpp"
+#include "types/array.hpp"
+#include "types/string.hpp"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+#include <vector>
+
+#ifdef DEBUG
+  #define debug(s) std::cerr << s << std::endl;
+#else
+  #define debug(s);
+#endif
+
+namespace VM {
+
+  static GObjectHeader* objects = NULL;
+  static long threshold = DEFAULT_GC_THRESHOLD;
+  static GGCStats stats;
+  // objects that have been marked, but whose references haven't been
+  // yet. a worklist rather than recursion, so long chains of objects
+  // can't run out the native stack.
+  static std::vector<GObjectHeader*> grey;
+
+  static void* track(GObjectHeader* header, GType* type, int totalSize) {
+    header->next = objects;
+    header->type = type;
+    header->size = totalSize;
+    objects = header;
+    stats.heapSize += totalSize;
+    return header + 1;
+  }
+
+  void* gcAllocate(GType* type, int size) {
+    int totalSize = sizeof(GObjectHeader) + size;
+    return track((GObjectHeader*) new char[totalSize](), type, totalSize);
+  }
+
+  void* poolAllocate(GObjectPool* pool, GType* type) {
+    if (pool->free == NULL) {
+      auto chunk = new char[pool->objectSize * POOL_CHUNK_SIZE];
+      for (int i = POOL_CHUNK_SIZE - 1; i >= 0; i--) {
+        auto header = (GObjectHeader*) (chunk + i * pool->objectSize);
+        header->next = pool->free;
+        pool->free = header;
+      }
+    }
+    auto header = pool->free;
+    pool->free = header->next;
+    memset(header, 0, pool->objectSize);
+    return track(header, type, pool->objectSize);
+  }
+
+  GObjectHeader* getObjectHeader(void* object) {
+    return ((GObjectHeader*) object) - 1;
+  }
+
+  void setGCThreshold(long bytes) {
+    threshold = bytes;
+  }
+
+  bool shouldCollectGarbage() {
+    return stats.heapSize >= threshold;
+  }
+
+  GGCStats& getGCStats() {
+    return stats;
+  }
+
+  GActivation*& getCurrentActivation() {
+    static GActivation* activation = NULL;
+    return activation;
+  }
+
+  // user classes: types that have an environment, and are instantiated
+  // from it.
+  static bool isClassType(GType* type) {
+    return !type->isPrimitive && type->environment != NULL &&
+      type != getBuiltinModuleType();
+  }
+
+  bool isTracedType(GType* type) {
+    return type != NULL &&
+      (isArrayType(type) || isStringType(type) || isTupleType(type) ||
+       type == getFunctionType() || isClassType(type));
+  }
+
+  static void markObject(void* object) {
+    auto header = getObjectHeader(object);
+    if (!header->marked) {
+      header->marked = true;
+      grey.push_back(header);
+    }
+  }
+
+  static void markValue(GType* type, GValue value) {
+    if (value.asNone == NULL || !isTracedType(type)) {
+      return;
+    }
+    // literals live for as long as the program, outside of the heap.
+    if (isStringType(type) && value.asString->isConstant) {
+      return;
+    }
+    markObject(value.asNone);
+  }
+
+  // the registers of an instance, typed by its environment.
+  static void markLocals(GEnvironment* environment, GValue* locals) {
+    int count = std::min(environment->localsCount, (int) environment->localsTypes.size());
+    for (int i = 0; i < count; i++) {
+      markValue(environment->localsTypes[i], locals[i]);
+    }
+  }
+
+  static void scanObject(GObjectHeader* header) {
+    auto type = header->type;
+    auto object = (void*) (header + 1);
+    if (isStringType(type)) {
+      return;
+    }
+    if (isArrayType(type)) {
+      auto array = (GArray*) object;
+      auto elementType = type->subTypes[0];
+      if (isTracedType(elementType)) {
+        for (int i = 0; i < array->size; i++) {
+          markValue(elementType, array->elements[i]);
+        }
+      }
+    } else if (isTupleType(type)) {
+      auto tuple = (GArray*) object;
+      for (int i = 0; i < tuple->size; i++) {
+        markValue(type->subTypes[i], tuple->elements[i]);
+      }
+    } else if (type != getFunctionType()) {
+      auto attributes = (GValue*) object;
+      for (int i = 0; i < type->attributeCount; i++) {
+        markValue(type->environment->localsTypes[i], attributes[i]);
+      }
+    }
+  }
+
+  static void markRoots() {
+    for (auto activation = getCurrentActivation(); activation != NULL;
+         activation = activation->previous) {
+      markLocals(activation->instance->environment, activation->instance->locals);
+      for (auto frame = activation->frame; frame != NULL; frame = frame->previous) {
+        markLocals(frame->instance.environment, frame->instance.locals);
+      }
+    }
+  }
+
+  static void freeObject(GObjectHeader* header) {
+    if (isClassType(header->type)) {
+      auto pool = header->type->pool;
+      header->next = pool->free;
+      pool->free = header;
+      return;
+    }
+    if (header->type == getFunctionType()) {
+      delete[] ((GFunctionInstance*) (header + 1))->globals;
+    }
+    delete[] (char*) header;
+  }
+
+  void collectGarbage() {
+    auto start = std::chrono::steady_clock::now();
+
+    markRoots();
+    while (!grey.empty()) {
+      auto header = grey.back();
+      grey.pop_back();
+      scanObject(header);
+    }
+
+    auto link = &objects;
+    while (*link != NULL) {
+      auto header = *link;
+      if (header->marked) {
+        header->marked = false;
+        link = &header->next;
+      } else {
+        *link = header->next;
+        stats.heapSize -= header->size;
+        stats.objectsFreed++;
+        freeObject(header);
+      }
+    }
+
+    // collect again once the heap has doubled, so the time spent
+    // collecting stays proportional to the time spent allocating.
+    threshold = std::max(threshold, stats.heapSize * 2);
+
+    auto pause = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+    stats.collections++;
+    stats.lastPause = pause;
+    stats.maxPause = std::max(stats.maxPause, (long) pause);
+    stats.totalPause += pause;
+    debug("GC: " << stats.heapSize << " bytes live, " << pause << "us");
+  }
+}
@@ -0,0 +1,93 @@
+#include "environment.hpp"
+#include "object.hpp"
+#include "stack.hpp"
+#include "type.hpp"
+
+#ifndef VM_GC_HPP
+#define VM_GC_HPP
+
+namespace VM {
+
+  /*
+    a precise mark and sweep collector, for everything the vm
+    allocates while it runs: arrays, tuples, strings, instances and
+    function instances.
+
+    every object starts with a GObjectHeader, which holds its type.
+    the collector uses the types to find the references in an object
+    (the element types of arrays and tuples, the attribute types of
+    instances), and the types of the registers of every frame to find
+    the references on the register stack.
+
+    collections only happen at safe points in the execution engine,
+    where everything alive is held by a register.
+   */
+  typedef struct GObjectHeader {
+    // every object allocated, for the sweep.
+    GObjectHeader* next;
+    GType* type;
+    // in bytes, the header included.
+    int size;
+    bool marked;
+  } GObjectHeader;
+
+  /*
+    objects of a single size, such as the instances of a class. they're
+    carved out of chunks, and the collector puts them back on the free
+    list of their pool rather than freeing them, so allocating one is
+    usually just taking it off the list.
+   */
+  typedef struct GObjectPool {
+    // in bytes, the header included.
+    int objectSize;
+    GObjectHeader* free;
+  } GObjectPool;
+
+  // the number of objects a pool allocates at once.
+  const int POOL_CHUNK_SIZE = 64;
+
+  typedef struct GGCStats {
+    // in bytes, headers included.
+    long heapSize;
+    long collections;
+    long objectsFreed;
+    // in microseconds.
+    long lastPause;
+    long maxPause;
+    long totalPause;
+  } GGCStats;
+
+  /*
+    an invocation of the execution engine. the engine keeps frame up to
+    date as it calls and returns, so the collector can walk every call
+    in progress.
+   */
+  typedef struct GActivation {
+    GEnvironmentInstance* instance;
+    GCallFrame* frame;
+    GActivation* previous;
+  } GActivation;
+
+  // the heap size the first collection happens at, unless
+  // setGCThreshold is called.
+  const long DEFAULT_GC_THRESHOLD = 8 * 1024 * 1024;
+
+  // returns size zeroed bytes, right after a header for type.
+  void* gcAllocate(GType* type, int size);
+  // the same, for an object the size of the objects of pool.
+  void* poolAllocate(GObjectPool* pool, GType* type);
+  GObjectHeader* getObjectHeader(void* object);
+
+  void setGCThreshold(long bytes);
+  bool shouldCollectGarbage();
+  void collectGarbage();
+  GGCStats& getGCStats();
+
+  GActivation*& getCurrentActivation();
+
+  // whether values of type are references to objects the collector
+  // manages.
+  bool isTracedType(GType* type);
+}
+
+#endif
@@ -0,0 +1,1552 @@
+#include "module_cache.hpp"
+#include "builtins.hpp"
+#include "exception.hpp"
+#include "function.hpp"
+#include "gc.hpp"
+#include "rootenvironment.hpp"
+#include "stack.hpp"
+#include "types/array.hpp"
+#include "types/primitives.hpp"
+#include "types/string.hpp"
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#ifdef DEBUG
+  #define debug(s) std::cerr << s << std::endl;
+#else
+  #define debug(s);
+#endif
+
+namespace VM {
+
+  // a run of records in a table: the index of the first, and how many.
+  // in the header, offset is from the start of the file instead.
+  typedef struct GCacheSpan {
+    uint32_t offset;
+    uint32_t count;
+  } GCacheSpan;
+
+  typedef struct GCacheHeader {
+    char magic[4];
+    uint32_t format;
+    GModuleCacheKey key;
+    // a hash of everything after the header.
+    uint64_t checksum;
+    GCacheSpan types;
+    GCacheSpan classes;
+    GCacheSpan environments;
+    GCacheSpan functions;
+    GCacheSpan bodies;
+    GCacheSpan constants;
+    GCacheSpan names;
+    // lists of indices, referred to by the other records.
+    GCacheSpan ints;
+    GCacheSpan code;
+    GCacheSpan strings;
+    // only in snapshots: the objects of the heap, and the values they
+    // and the registers of the module hold.
+    GCacheSpan objects;
+    GCacheSpan values;
+    // the code at the top level of the module.
+    int32_t body;
+    // the values of the registers of the module, in values. empty
+    // unless it's a snapshot.
+    GCacheSpan registers;
+  } GCacheHeader;
+
+  enum GCacheTypeKind { KNOWN_TYPE, ARRAY_TYPE, TUPLE_TYPE, CLASS_TYPE };
+
+  typedef struct GCacheType {
+    int32_t kind;
+    // the known type, or the class.
+    int32_t index;
+    GCacheSpan subTypes;
+  } GCacheType;
+
+  typedef struct GCacheClass {
+    // strings are an offset into the pool of strings.
+    uint32_t name;
+    int32_t attributeCount;
+    int32_t functionCount;
+    int32_t environment;
+  } GCacheClass;
+
+  typedef struct GCacheName {
+    uint32_t name;
+    int32_t value;
+  } GCacheName;
+
+  // the first environment is the module. its parent is the
+  // environment it's loaded into's, so it isn't saved.
+  typedef struct GCacheEnvironment {
+    int32_t parent;
+    int32_t isModule;
+    int32_t localsCount;
+    GCacheSpan localsTypes;
+    int32_t globalsCount;
+    GCacheSpan globalsTypes;
+    GCacheSpan indicesInParent;
+    GCacheSpan functions;
+    GCacheSpan classes;
+    GCacheSpan localsByName;
+    GCacheSpan globalsByName;
+    GCacheSpan functionsByName;
+    GCacheSpan classesByName;
+  } GCacheEnvironment;
+
+  typedef struct GCacheFunction {
+    int32_t argumentCount;
+    GCacheSpan argumentNames;
+    GCacheSpan argumentTypes;
+    int32_t environment;
+    // -1 for a function that was never generated.
+    int32_t body;
+    int32_t returnType;
+    int32_t isStatic;
+  } GCacheFunction;
+
+  typedef struct GCacheBody {
+    // in words, from the start of the code.
+    GCacheSpan code;
+    GCacheSpan constants;
+  } GCacheBody;
+
+  enum GCacheConstantKind {
+    // constants no instruction refers to any more.
+    UNUSED_CONSTANT,
+    FLOAT_CONSTANT,
+    STRING_CONSTANT,
+    CSTRING_CONSTANT,
+    TYPE_CONSTANT,
+    FUNCTION_CONSTANT,
+    PRIMITIVE_METHOD_CONSTANT
+  };
+
+  typedef struct GCacheConstant {
+    int32_t kind;
+    // a float is split over both.
+    uint32_t first;
+    uint32_t second;
+  } GCacheConstant;
+
+  /*
+    an object of the heap of a snapshot. what it is follows from its
+    type: a string has its bytes in the pool of strings, an array, a
+    tuple or an instance its elements (or attributes) in values, and a
+    function object the function it was created from.
+
+    a value is the bits of a bool, char, int or float, or for anything
+    else, the index of the object or class it refers to plus one, and
+    zero for none.
+   */
+  typedef struct GCacheObject {
+    int32_t type;
+    // the bytes of a string, or the function of a function object.
+    uint32_t data;
+    int32_t size;
+    int32_t isConstant;
+    GCacheSpan values;
+  } GCacheObject;
+
+  // types that always exist, and are saved by their position here.
+  typedef GType* (*GTypeGetter)();
+  static const GTypeGetter knownTypes[] = {
+    getBoolType, getBuiltinType, getCharType, getClassType, getFloatType,
+    getFunctionType, getInt32Type, getModuleType, getNoneType,
+    getStringType, getBuiltinModuleType
+  };
+  static const int KNOWN_TYPE_COUNT = sizeof(knownTypes) / sizeof(GTypeGetter);
+
+  static const uint64_t EMPTY_HASH = 14695981039346656037ull;
+
+  // continues hash over bytes, so a hash can be built up piece by piece.
+  static uint64_t hashBytes(const char* bytes, size_t size, uint64_t hash = EMPTY_HASH) {
+    for (size_t i = 0; i < size; i++) {
+      hash = (hash ^ (unsigned char) bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+  }
+
+  // the build id the linker stamped the running binary with: a hash of
+  // everything linked into it, so it changes along with the compiler,
+  // and is the same for builds of the same code.
+  static int findBuildId(struct dl_phdr_info* info, size_t, void* data) {
+    auto buildId = (std::string*) data;
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+      auto& segment = info->dlpi_phdr[i];
+      if (segment.p_type != PT_NOTE) {
+        continue;
+      }
+      auto note = (const char*) (info->dlpi_addr + segment.p_vaddr);
+      auto end = note + segment.p_memsz;
+      while (note + sizeof(ElfW(Nhdr)) <= end) {
+        auto header = (const ElfW(Nhdr)*) note;
+        auto name = note + sizeof(ElfW(Nhdr));
+        auto description = name + ((header->n_namesz + 3) & ~3);
+        if (header->n_type == NT_GNU_BUILD_ID && header->n_namesz == 4 &&
+            memcmp(name, "GNU", 4) == 0) {
+          buildId->assign(description, header->n_descsz);
+          break;
+        }
+        note = description + ((header->n_descsz + 3) & ~3);
+      }
+    }
+    // the executable comes first.
+    return 1;
+  }
+
+  // the compiler is known by the binary it's part of: its build id,
+  // or without one, its contents. MODULE_CACHE_FORMAT is still part of
+  // it, for builds that can't be told apart that way.
+  static uint64_t getCompilerHash() {
+    static uint64_t hash = 0;
+    if (hash == 0) {
+      auto format = "greyhawk " + std::to_string(MODULE_CACHE_FORMAT);
+      hash = hashBytes(format.c_str(), format.size());
+      std::string buildId;
+      dl_iterate_phdr(findBuildId, &buildId);
+      if (buildId.empty()) {
+        std::ifstream binary("/proc/self/exe", std::ios::binary);
+        buildId.assign(std::istreambuf_iterator<char>(binary),
+                       std::istreambuf_iterator<char>());
+      }
+      hash = hashBytes(buildId.data(), buildId.size(), hash);
+    }
+    return hash;
+  }
+
+  GModuleCacheKey getModuleCacheKey(const char* source, size_t size,
+                                    int optimizationLevel) {
+    GModuleCacheKey key;
+    memset(&key, 0, sizeof(key));
+    key.sourceHash = hashBytes(source, size);
+    key.compilerHash = getCompilerHash();
+    key.optimizationLevel = optimizationLevel;
+    return key;
+  }
+
+  // a snapshot isn't of a source, and its code runs at any level.
+  static GModuleCacheKey getSnapshotKey() {
+    GModuleCacheKey key;
+    memset(&key, 0, sizeof(key));
+    key.compilerHash = getCompilerHash();
+    key.optimizationLevel = -1;
+    return key;
+  }
+
+  std::string getModuleCachePath(const std::string& sourcePath) {
+    return sourcePath + "c";
+  }
+
+  // which kind of constant an instruction reads from the pool.
+  static GCacheConstantKind getConstantKind(GOPCODE op) {
+    switch (op) {
+    case ARRAY_ALLOCATE:
+      return TYPE_CONSTANT;
+    case CALL_DIRECT:
+    case CALL_METHOD_DIRECT:
+      return FUNCTION_CONSTANT;
+    case LOAD_CONSTANT_FLOAT:
+      return FLOAT_CONSTANT;
+    case LOAD_CONSTANT_STRING:
+      return STRING_CONSTANT;
+    case LOAD_MODULE:
+      return CSTRING_CONSTANT;
+    case PRIMITIVE_METHOD_CALL:
+      return PRIMITIVE_METHOD_CONSTANT;
+    default:
+      throw VMException(std::string("unable to cache the constants of ") +
+                        getOpInfo(op).name);
+    }
+  }
+
+  /*
+    flattens a module into the tables of a cache. objects are given
+    their index before the ones they refer to are added, as functions
+    can call themselves, and classes hold their own type.
+   */
+  class GModuleCacheWriter {
+  public:
+    std::vector<GCacheType> types;
+    std::vector<GCacheClass> classes;
+    std::vector<GCacheEnvironment> environments;
+    std::vector<GCacheFunction> functions;
+    std::vector<GCacheBody> bodies;
+    std::vector<GCacheConstant> constants;
+    std::vector<GCacheName> names;
+    std::vector<int32_t> ints;
+    std::vector<GOPARG> code;
+    std::vector<char> strings;
+    std::vector<GCacheObject> objects;
+    std::vector<uint64_t> values;
+
+    int32_t addType(GType* type) {
+      if (type == NULL) {
+        return -1;
+      }
+      auto found = typeIndices.find(type);
+      if (found != typeIndices.end()) {
+        return found->second;
+      }
+
+      GCacheType record = { KNOWN_TYPE, -1, { 0, 0 } };
+      for (int i = 0; i < KNOWN_TYPE_COUNT; i++) {
+        if (knownTypes[i]() == type) {
+          record.index = i;
+        }
+      }
+
+      if (record.index < 0 && (isArrayType(type) || isTupleType(type))) {
+        // subtypes come first, so they're rebuilt before this one.
+        std::vector<int32_t> subTypes;
+        for (int i = 0; i < type->subTypes.length(); i++) {
+          subTypes.push_back(addType(type->subTypes[i]));
+        }
+        record.kind = isArrayType(type) ? ARRAY_TYPE : TUPLE_TYPE;
+        record.subTypes = addInts(subTypes);
+      } else if (record.index < 0) {
+        if (type->environment == NULL) {
+          throw VMException("unable to cache the type " + type->name);
+        }
+        record.kind = CLASS_TYPE;
+        record.index = classes.size();
+        classes.push_back(GCacheClass());
+      }
+
+      int32_t index = types.size();
+      typeIndices[type] = index;
+      types.push_back(record);
+
+      if (record.kind == CLASS_TYPE) {
+        GCacheClass cls = {
+          .name = addString(type->name),
+          .attributeCount = type->attributeCount,
+          .functionCount = type->functionCount,
+          .environment = addEnvironment(type->environment)
+        };
+        classes[record.index] = cls;
+      }
+      return index;
+    }
+
+    int32_t addEnvironment(GEnvironment* environment) {
+      auto found = environmentIndices.find(environment);
+      if (found != environmentIndices.end()) {
+        return found->second;
+      }
+      int32_t index = environments.size();
+      environmentIndices[environment] = index;
+      environments.push_back(GCacheEnvironment());
+
+      std::vector<int32_t> localsTypes, globalsTypes, functionIndices, classIndices;
+      for (auto type : environment->localsTypes) {
+        localsTypes.push_back(addType(type));
+      }
+      for (auto type : environment->globalsTypes) {
+        globalsTypes.push_back(addType(type));
+      }
+      for (auto function : environment->functions) {
+        functionIndices.push_back(addFunction(function));
+      }
+      for (auto cls : environment->classes) {
+        classIndices.push_back(addType(cls));
+      }
+
+      GCacheEnvironment record = {
+        .parent = -1,
+        .isModule = environment->isModule,
+        .localsCount = environment->localsCount,
+        .localsTypes = addInts(localsTypes),
+        .globalsCount = environment->globalsCount,
+        .globalsTypes = addInts(globalsTypes),
+        .indicesInParent = addInts(environment->indicesInParent),
+        .functions = addInts(functionIndices),
+        .classes = addInts(classIndices),
+        .localsByName = addNames(environment->localsByName),
+        .globalsByName = addNames(environment->globalsByName),
+        .functionsByName = addNames(environment->functionsByName),
+        .classesByName = addNames(environment->classesByName)
+      };
+      environments[index] = record;
+      return index;
+    }
+
+    // an environment can be reached before the one it's declared in
+    // (through the type of an argument, say), so parents are only
+    // filled in once everything has been added.
+    void addParents() {
+      for (auto& kv : environmentIndices) {
+        auto parent = environmentIndices.find(kv.first->parent);
+        if (parent != environmentIndices.end()) {
+          environments[kv.second].parent = parent->second;
+        }
+      }
+    }
+
+    int32_t addFunction(GFunction* function) {
+      auto found = functionIndices.find(function);
+      if (found != functionIndices.end()) {
+        return found->second;
+      }
+      if (function->isNative) {
+        throw VMException("unable to cache a native function");
+      }
+      int32_t index = functions.size();
+      functionIndices[function] = index;
+      functions.push_back(GCacheFunction());
+
+      std::vector<int32_t> argumentNames, argumentTypes;
+      for (int i = 0; i < function->argumentCount; i++) {
+        argumentNames.push_back(function->argumentNames == NULL ?
+                                addString("") : addString(function->argumentNames[i]));
+        argumentTypes.push_back(function->argumentTypes == NULL ?
+                                -1 : addType(function->argumentTypes[i]));
+      }
+
+      GCacheFunction record = {
+        .argumentCount = function->argumentCount,
+        .argumentNames = addInts(argumentNames),
+        .argumentTypes = addInts(argumentTypes),
+        .environment = function->environment == NULL ?
+          -1 : addEnvironment(function->environment),
+        .body = function->instructions == NULL ? -1 : addBody(function->instructions),
+        .returnType = addType(function->returnType),
+        .isStatic = function->isStatic
+      };
+      functions[index] = record;
+      return index;
+    }
+
+    // the pool isn't typed, so the kind of each constant is worked
+    // out from the instructions that read it.
+    int32_t addBody(GBytecode* body) {
+      std::vector<GCacheConstantKind> kinds(body->constantsCount, UNUSED_CONSTANT);
+      for (int pc = 0; pc < body->size; pc += getInstructionSize(body->code + pc)) {
+        auto op = getOpcode(body->code[pc]);
+        auto operands = getOpInfo(op).operands;
+        for (int i = 0; operands[i] != '\0'; i++) {
+          if (operands[i] == 'k') {
+            kinds[body->code[pc + 1 + i].constantIndex] = getConstantKind(op);
+          }
+        }
+      }
+
+      GCacheBody record = {
+        .code = { (uint32_t) code.size(), (uint32_t) body->size },
+        .constants = { (uint32_t) constants.size(), (uint32_t) body->constantsCount }
+      };
+      code.insert(code.end(), body->code, body->code + body->size);
+      // code that has run is saved as it was before it was linked.
+      for (uint32_t pc = 0; pc < record.code.count; ) {
+        auto& word = code[record.code.offset + pc];
+        pc += getInstructionSize(&word);
+        word.op = getOpcode(word);
+      }
+      // constants refer to functions and types, which may add bodies
+      // of their own, so the records are filled in once they're all
+      // in place.
+      constants.resize(constants.size() + body->constantsCount);
+      for (int i = 0; i < body->constantsCount; i++) {
+        auto constant = getConstant(kinds[i], body->constants[i]);
+        constants[record.constants.offset + i] = constant;
+      }
+      int32_t index = bodies.size();
+      bodies.push_back(record);
+      return index;
+    }
+
+    uint32_t addString(const std::string& string) {
+      auto found = stringOffsets.find(string);
+      if (found != stringOffsets.end()) {
+        return found->second;
+      }
+      uint32_t offset = strings.size();
+      strings.insert(strings.end(), string.begin(), string.end());
+      strings.push_back('\0');
+      stringOffsets[string] = offset;
+      return offset;
+    }
+
+    // the values of the registers of root that aren't temporaries, and
+    // every object they reach. objects are numbered as they're found,
+    // and their own values saved once the ones before them are, so the
+    // values of each one are in a single run.
+    GCacheSpan addRegisters(GEnvironmentInstance& root) {
+      auto environment = root.environment;
+      std::vector<uint64_t> registers(environment->localsCount, 0);
+      for (int i = 0; i < environment->localsCount; i++) {
+        bool isTemporary = i < (int) environment->localsTemporary.size() &&
+          environment->localsTemporary[i];
+        if (i < (int) environment->localsTypes.size() && !isTemporary) {
+          registers[i] = addValue(environment->localsTypes[i], root.locals[i], root);
+        }
+      }
+      auto span = addValues(registers);
+
+      for (size_t i = 0; i < objects.size(); i++) {
+        auto type = heap[i].first;
+        auto object = heap[i].second;
+        std::vector<uint64_t> elements;
+        if (isArrayType(type) || isTupleType(type)) {
+          auto array = object.asArray;
+          for (int j = 0; j < array->size; j++) {
+            auto elementType = isArrayType(type) ? type->subTypes[0] : type->subTypes[j];
+            elements.push_back(addValue(elementType, array->elements[j], root));
+          }
+        } else if (!isStringType(type) && type != getFunctionType()) {
+          for (int j = 0; j < type->attributeCount; j++) {
+            elements.push_back(addValue(type->environment->localsTypes[j],
+                                        object.asInstance[j], root));
+          }
+        }
+        objects[i].values = addValues(elements);
+      }
+      return span;
+    }
+
+  private:
+    std::map<GType*, int32_t> typeIndices;
+    std::map<GEnvironment*, int32_t> environmentIndices;
+    std::map<GFunction*, int32_t> functionIndices;
+    std::map<std::string, uint32_t> stringOffsets;
+    std::map<void*, uint64_t> objectIndices;
+    std::vector<std::pair<GType*, GValue>> heap;
+
+    GCacheSpan addValues(const std::vector<uint64_t>& added) {
+      GCacheSpan span = { (uint32_t) values.size(), (uint32_t) added.size() };
+      values.insert(values.end(), added.begin(), added.end());
+      return span;
+    }
+
+    uint64_t addValue(GType* type, GValue value, GEnvironmentInstance& root) {
+      if (type == getBoolType() || type == getCharType() || type == getInt32Type() ||
+          type == getFloatType() || type == getNoneType()) {
+        uint64_t bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+      }
+      if (value.asNone == NULL) {
+        return 0;
+      }
+      if (type == getClassType()) {
+        // classes bound to a frame only exist while it does.
+        if (value.asType->methodGlobals != NULL) {
+          throw VMException("unable to save the class " + value.asType->name +
+                            ", as it was declared in a function");
+        }
+        return addType(value.asType) + 1;
+      }
+      if (type == NULL || !isTracedType(type)) {
+        throw VMException("unable to save a value of type " +
+                          (type == NULL ? std::string("none") : type->name));
+      }
+      auto found = objectIndices.find(value.asNone);
+      if (found != objectIndices.end()) {
+        return found->second;
+      }
+
+      GCacheObject record = { addType(type), 0, 0, 0, { 0, 0 } };
+      if (isStringType(type)) {
+        auto string = value.asString;
+        record.data = addString(std::string(string->bytes, string->size));
+        record.size = string->size;
+        record.isConstant = string->isConstant;
+      } else if (type == getFunctionType()) {
+        auto function = value.asFunction;
+        if (&function->parentEnv != &root) {
+          throw VMException("unable to save a function created in a call");
+        }
+        record.data = addFunction(function->function);
+      } else if (!isArrayType(type) && !isTupleType(type) &&
+                 getObjectHeader(value.asInstance)->type != type) {
+        throw VMException("unable to save an instance of " + type->name +
+                          ", as its class was declared in a function");
+      }
+      uint64_t index = objects.size() + 1;
+      objectIndices[value.asNone] = index;
+      objects.push_back(record);
+      heap.push_back(std::make_pair(type, value));
+      return index;
+    }
+
+    GCacheSpan addInts(const std::vector<int32_t>& values) {
+      GCacheSpan span = { (uint32_t) ints.size(), (uint32_t) values.size() };
+      ints.insert(ints.end(), values.begin(), values.end());
+      return span;
+    }
+
+    GCacheSpan addNames(GSymbolTable& table) {
+      GCacheSpan span = { (uint32_t) names.size(), (uint32_t) table.size() };
+      for (auto& kv : table) {
+        names.push_back(GCacheName { addString(gstd::symbolName(kv.first)), kv.second });
+      }
+      return span;
+    }
+
+    GCacheConstant getConstant(GCacheConstantKind kind, GValue value) {
+      GCacheConstant constant = { kind, 0, 0 };
+      switch (kind) {
+      case UNUSED_CONSTANT:
+        break;
+      case FLOAT_CONSTANT: {
+        uint64_t bits;
+        memcpy(&bits, &value.asFloat, sizeof(bits));
+        constant.first = (uint32_t) bits;
+        constant.second = (uint32_t) (bits >> 32);
+        break;
+      }
+      case STRING_CONSTANT:
+        constant.first = addString(std::string(value.asString->bytes,
+                                               value.asString->size));
+        constant.second = value.asString->size;
+        break;
+      case CSTRING_CONSTANT:
+        constant.first = addString(value.asCString);
+        break;
+      case TYPE_CONSTANT:
+        constant.first = addType(value.asType);
+        break;
+      case FUNCTION_CONSTANT:
+        constant.first = addFunction(value.asRawFunction);
+        break;
+      case PRIMITIVE_METHOD_CONSTANT:
+        for (auto& type : primitives) {
+          for (auto& method : type.second) {
+            if (method.second.rawMethod == value.asPrimitiveMethod) {
+              constant.first = addString(type.first);
+              constant.second = addString(method.first);
+              return constant;
+            }
+          }
+        }
+        throw VMException("unable to cache an unknown primitive method");
+      }
+      return constant;
+    }
+  };
+
+  template <class T>
+  static void writeSection(FILE* file, GCacheSpan& span, std::vector<T>& records,
+                           uint64_t& checksum) {
+    // every section starts on an 8 byte boundary.
+    static const char padding[8] = {};
+    long position = ftell(file);
+    size_t paddingSize = (8 - position % 8) % 8;
+    fwrite(padding, 1, paddingSize, file);
+    checksum = hashBytes(padding, paddingSize, checksum);
+    span.offset = ftell(file);
+    span.count = records.size();
+    if (records.size() > 0) {
+      fwrite(&records[0], sizeof(T), records.size(), file);
+      checksum = hashBytes((const char*) &records[0], sizeof(T) * records.size(), checksum);
+    }
+  }
+
+  // written to the side and moved into place, so a cache is never seen
+  // half written.
+  static bool writeCache(const std::string& path, const GModuleCacheKey& key,
+                         GModuleCacheWriter& writer, GCacheHeader& header) {
+    auto temporaryPath = path + "." + std::to_string(getpid());
+    auto file = fopen(temporaryPath.c_str(), "wb");
+    if (file == NULL) {
+      return false;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    uint64_t checksum = EMPTY_HASH;
+    writeSection(file, header.types, writer.types, checksum);
+    writeSection(file, header.classes, writer.classes, checksum);
+    writeSection(file, header.environments, writer.environments, checksum);
+    writeSection(file, header.functions, writer.functions, checksum);
+    writeSection(file, header.bodies, writer.bodies, checksum);
+    writeSection(file, header.constants, writer.constants, checksum);
+    writeSection(file, header.names, writer.names, checksum);
+    writeSection(file, header.ints, writer.ints, checksum);
+    writeSection(file, header.code, writer.code, checksum);
+    writeSection(file, header.strings, writer.strings, checksum);
+    writeSection(file, header.objects, writer.objects, checksum);
+    writeSection(file, header.values, writer.values, checksum);
+
+    memcpy(header.magic, "GHC", 4);
+    header.format = MODULE_CACHE_FORMAT;
+    header.key = key;
+    header.checksum = checksum;
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+
+    bool written = !ferror(file);
+    written = fclose(file) == 0 && written;
+    if (!written || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+      unlink(temporaryPath.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  bool writeModuleCache(const std::string& path, const GModuleCacheKey& key,
+                        GEnvironment* environment, GBytecode* body) {
+    GModuleCacheWriter writer;
+    GCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    try {
+      writer.addEnvironment(environment);
+      header.body = writer.addBody(body);
+      writer.addParents();
+    } catch (VMException& e) {
+      debug("not caching module: " << e.message);
+      return false;
+    }
+    return writeCache(path, key, writer, header);
+  }
+
+  bool writeSnapshot(const std::string& path, GEnvironmentInstance& root) {
+    GModuleCacheWriter writer;
+    GCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    // its code has already run, so the top level is left empty.
+    GOPARG end;
+    end.op = END;
+    GBytecode body = { .code = &end, .size = 1 };
+    writer.addEnvironment(root.environment);
+    header.body = writer.addBody(&body);
+    header.registers = writer.addRegisters(root);
+    writer.addParents();
+    return writeCache(path, getSnapshotKey(), writer, header);
+  }
+
+  /*
+    rebuilds a module from a mapped cache. every object is allocated
+    first, so records can refer to ones that come after them.
+
+    the records are checked before anything is built: every index has
+    to be in its table, every span and offset in its section, and the
+    code made only of known instructions, on registers and constants
+    of its own, that don't jump or run off its end. the types of the
+    values in registers aren't: a cache that passes its checksum is
+    trusted as much as the source next to it.
+   */
+  class GModuleCacheReader {
+  public:
+    GModuleCacheReader(const char* _base, GCacheHeader* _header) :
+      base(_base), header(_header) {}
+
+    bool check(GEnvironment* module) {
+      auto typeRecords = section<GCacheType>(header->types);
+      auto classRecords = section<GCacheClass>(header->classes);
+      auto environmentRecords = section<GCacheEnvironment>(header->environments);
+      auto functionRecords = section<GCacheFunction>(header->functions);
+      auto bodyRecords = section<GCacheBody>(header->bodies);
+
+      for (uint32_t i = 0; i < header->types.count; i++) {
+        auto& record = typeRecords[i];
+        if (!isSpan(record.subTypes, header->ints)) {
+          return false;
+        }
+        switch (record.kind) {
+        case KNOWN_TYPE:
+          if (!isIndex(record.index, KNOWN_TYPE_COUNT)) {
+            return false;
+          }
+          break;
+        case ARRAY_TYPE:
+          // an array of a type that comes before it.
+          if (record.subTypes.count != 1 || !isIndex(intAt(record.subTypes, 0), i)) {
+            return false;
+          }
+          break;
+        case TUPLE_TYPE:
+          for (uint32_t j = 0; j < record.subTypes.count; j++) {
+            if (!isOptionalIndex(intAt(record.subTypes, j), i)) {
+              return false;
+            }
+          }
+          break;
+        case CLASS_TYPE:
+          if (!isIndex(record.index, header->classes.count)) {
+            return false;
+          }
+          break;
+        default:
+          return false;
+        }
+      }
+
+      for (uint32_t i = 0; i < header->environments.count; i++) {
+        auto& record = environmentRecords[i];
+        // the parent of the module is the one it's loaded into.
+        int32_t parentLocals = module->parent == NULL ? 0 : module->parent->localsCount;
+        int32_t parentGlobals = module->parent == NULL ? 0 : module->parent->globalsCount;
+        if (i == 0 ? record.parent != -1 : !isOptionalIndex(record.parent, header->environments.count)) {
+          return false;
+        }
+        if (record.parent >= 0) {
+          parentLocals = environmentRecords[record.parent].localsCount;
+          parentGlobals = environmentRecords[record.parent].globalsCount;
+        }
+        // names are looked up with their types, and every global is
+        // resolved with its index in the parent.
+        int64_t namedLocals = std::min<int64_t>(record.localsCount, record.localsTypes.count);
+        if (record.localsCount < 0 || record.globalsCount < 0 ||
+            record.globalsTypes.count < (uint32_t) record.globalsCount ||
+            record.indicesInParent.count != record.globalsTypes.count ||
+            !areTypes(record.localsTypes) || !areTypes(record.globalsTypes) ||
+            !areIndices(record.functions, header->functions.count) ||
+            !areIndices(record.classes, header->types.count) ||
+            !isSpan(record.indicesInParent, header->ints)) {
+          return false;
+        }
+        // a register of the parent, or -(n + 1) for its global n.
+        for (uint32_t j = 0; j < record.indicesInParent.count; j++) {
+          auto index = intAt(record.indicesInParent, j);
+          if (index >= 0 ? index >= parentLocals : -(int64_t) index - 1 >= parentGlobals) {
+            return false;
+          }
+        }
+        if (!areNames(record.localsByName, namedLocals) ||
+            !areNames(record.globalsByName, record.globalsCount) ||
+            !areNames(record.functionsByName, record.functions.count) ||
+            !areNames(record.classesByName, record.classes.count)) {
+          return false;
+        }
+      }
+
+      for (uint32_t i = 0; i < header->classes.count; i++) {
+        auto& record = classRecords[i];
+        if (!isString(record.name) ||
+            !isIndex(record.environment, header->environments.count)) {
+          return false;
+        }
+        // the attributes are the first locals of the environment, and
+        // the methods its last functions.
+        auto& environment = environmentRecords[record.environment];
+        int64_t attributes = std::min<int64_t>(environment.localsCount,
+                                               environment.localsTypes.count);
+        if (!isIndex(record.attributeCount, attributes + 1) ||
+            !isIndex(record.functionCount, environment.functions.count + 1)) {
+          return false;
+        }
+      }
+
+      // every body runs in a single environment, whose registers and
+      // tables its code refers to.
+      std::vector<int32_t> bodyEnvironments(header->bodies.count, -1);
+      bodyEnvironments[header->body] = 0;
+      for (uint32_t i = 0; i < header->functions.count; i++) {
+        auto& record = functionRecords[i];
+        if (record.argumentCount < 0 ||
+            record.argumentNames.count != (uint32_t) record.argumentCount ||
+            record.argumentTypes.count != (uint32_t) record.argumentCount ||
+            !isSpan(record.argumentNames, header->ints) ||
+            !areTypes(record.argumentTypes) ||
+            !isOptionalIndex(record.returnType, header->types.count) ||
+            !isOptionalIndex(record.environment, header->environments.count) ||
+            !isOptionalIndex(record.body, header->bodies.count) ||
+            (record.body >= 0 && record.environment < 0)) {
+          return false;
+        }
+        for (int j = 0; j < record.argumentCount; j++) {
+          if (!isString(intAt(record.argumentNames, j))) {
+            return false;
+          }
+        }
+        if (record.body >= 0) {
+          auto& environment = bodyEnvironments[record.body];
+          if (environment >= 0 && environment != record.environment) {
+            return false;
+          }
+          environment = record.environment;
+        }
+      }
+
+      for (uint32_t i = 0; i < header->bodies.count; i++) {
+        if (!isBody(bodyRecords[i], bodyEnvironments[i])) {
+          return false;
+        }
+      }
+      return isHeap();
+    }
+
+    GBytecode* load(GEnvironment* module) {
+      auto typeRecords = section<GCacheType>(header->types);
+      auto classRecords = section<GCacheClass>(header->classes);
+      auto environmentRecords = section<GCacheEnvironment>(header->environments);
+      auto functionRecords = section<GCacheFunction>(header->functions);
+      auto bodyRecords = section<GCacheBody>(header->bodies);
+
+      for (uint32_t i = 0; i < header->classes.count; i++) {
+        classes.push_back(new GType { .subTypes = gstd::Array<GType*>(0) });
+      }
+      for (uint32_t i = 0; i < header->environments.count; i++) {
+        environments.push_back(i == 0 ? module : new GEnvironment());
+      }
+      for (uint32_t i = 0; i < header->functions.count; i++) {
+        functions.push_back(new GFunction());
+      }
+
+      // subtypes always come before the types made of them.
+      for (uint32_t i = 0; i < header->types.count; i++) {
+        auto& record = typeRecords[i];
+        switch (record.kind) {
+        case KNOWN_TYPE:
+          types.push_back(knownTypes[record.index]());
+          break;
+        case ARRAY_TYPE:
+          types.push_back(getArrayType(getType(intAt(record.subTypes, 0))));
+          break;
+        case TUPLE_TYPE: {
+          gstd::Array<GType*> subTypes(record.subTypes.count);
+          for (uint32_t j = 0; j < record.subTypes.count; j++) {
+            subTypes[j] = getType(intAt(record.subTypes, j));
+          }
+          types.push_back(getTupleType(subTypes));
+          break;
+        }
+        case CLASS_TYPE:
+          types.push_back(classes[record.index]);
+          break;
+        }
+      }
+
+      for (uint32_t i = 0; i < header->classes.count; i++) {
+        auto& record = classRecords[i];
+        auto cls = classes[i];
+        cls->name = string(record.name);
+        cls->attributeCount = record.attributeCount;
+        cls->functionCount = record.functionCount;
+        cls->environment = environments[record.environment];
+      }
+
+      for (uint32_t i = 0; i < header->bodies.count; i++) {
+        bodies.push_back(loadBody(bodyRecords[i]));
+      }
+
+      for (uint32_t i = 0; i < header->functions.count; i++) {
+        auto& record = functionRecords[i];
+        auto function = functions[i];
+        function->argumentCount = record.argumentCount;
+        function->argumentNames = new std::string[record.argumentCount];
+        function->argumentTypes = new GType*[record.argumentCount];
+        for (int j = 0; j < record.argumentCount; j++) {
+          function->argumentNames[j] = string(intAt(record.argumentNames, j));
+          function->argumentTypes[j] = getType(intAt(record.argumentTypes, j));
+        }
+        function->environment = record.environment < 0 ?
+          NULL : environments[record.environment];
+        function->instructions = record.body < 0 ? NULL : bodies[record.body];
+        function->returnType = getType(record.returnType);
+        function->isStatic = record.isStatic;
+      }
+
+      for (uint32_t i = 0; i < header->environments.count; i++) {
+        loadEnvironment(environmentRecords[i], environments[i]);
+      }
+      return bodies[header->body];
+    }
+
+    // the objects of a snapshot are all allocated before any of them is
+    // filled in, as they can refer to each other in any order.
+    void loadHeap(GEnvironmentInstance& root) {
+      auto objectRecords = section<GCacheObject>(header->objects);
+      for (uint32_t i = 0; i < header->objects.count; i++) {
+        auto& record = objectRecords[i];
+        auto type = getType(record.type);
+        GValue object;
+        if (isStringType(type)) {
+          object.asString = record.isConstant ?
+            internString(std::string(string(record.data), record.size)) :
+            createString(string(record.data), record.size);
+        } else if (type == getFunctionType()) {
+          object.asFunction = functions[record.data]->createInstance(root);
+        } else if (isArrayType(type) || isTupleType(type)) {
+          object.asArray = allocateArray(type, record.values.count);
+        } else {
+          object.asInstance = type->instantiate();
+        }
+        heap.push_back(object);
+      }
+
+      for (uint32_t i = 0; i < header->objects.count; i++) {
+        auto& record = objectRecords[i];
+        auto type = getType(record.type);
+        auto values = section<uint64_t>(header->values) + record.values.offset;
+        for (uint32_t j = 0; j < record.values.count; j++) {
+          if (isArrayType(type)) {
+            heap[i].asArray->elements[j] = getValue(type->subTypes[0], values[j]);
+          } else if (isTupleType(type)) {
+            heap[i].asArray->elements[j] = getValue(type->subTypes[j], values[j]);
+          } else {
+            heap[i].asInstance[j] = getValue(type->environment->localsTypes[j], values[j]);
+          }
+        }
+      }
+
+      auto values = section<uint64_t>(header->values) + header->registers.offset;
+      auto& localsTypes = root.environment->localsTypes;
+      for (uint32_t i = 0; i < header->registers.count; i++) {
+        root.locals[i] = getValue(i < localsTypes.size() ? localsTypes[i] : NULL, values[i]);
+      }
+    }
+
+  private:
+    const char* base;
+    GCacheHeader* header;
+    std::vector<GType*> classes;
+    std::vector<GType*> types;
+    std::vector<GEnvironment*> environments;
+    std::vector<GFunction*> functions;
+    std::vector<GBytecode*> bodies;
+    std::vector<GValue> heap;
+
+    static bool isRawType(GType* type) {
+      return type == getBoolType() || type == getCharType() ||
+        type == getInt32Type() || type == getFloatType() || type == getNoneType();
+    }
+
+    GValue getValue(GType* type, uint64_t bits) {
+      GValue value;
+      if (isRawType(type)) {
+        memcpy(&value, &bits, sizeof(value));
+      } else if (bits == 0) {
+        value.asNone = NULL;
+      } else if (type == getClassType()) {
+        value.asType = types[bits - 1];
+      } else {
+        value = heap[bits - 1];
+      }
+      return value;
+    }
+
+    // the known type a type record is, or NULL for any other.
+    GType* getKnownType(int32_t index) {
+      auto& record = section<GCacheType>(header->types)[index];
+      return record.kind == KNOWN_TYPE ? knownTypes[record.index]() : NULL;
+    }
+
+    // a value read as the type at index: the bits of a primitive, a
+    // class, or an object of that very type.
+    bool isValue(int32_t type, uint64_t bits) {
+      if (bits == 0) {
+        return true;
+      }
+      if (type < 0) {
+        return false;
+      }
+      auto known = getKnownType(type);
+      if (isRawType(known)) {
+        return true;
+      }
+      if (known == getClassType()) {
+        return bits - 1 < header->types.count &&
+          section<GCacheType>(header->types)[bits - 1].kind == CLASS_TYPE;
+      }
+      if (known != NULL && known != getStringType() && known != getFunctionType()) {
+        return false;
+      }
+      return bits - 1 < header->objects.count &&
+        section<GCacheObject>(header->objects)[bits - 1].type == type;
+    }
+
+    bool areValues(GCacheSpan& span, GCacheSpan& types, int32_t typeCount) {
+      auto values = section<uint64_t>(header->values) + span.offset;
+      for (uint32_t i = 0; i < span.count; i++) {
+        auto type = (int32_t) i < typeCount ? intAt(types, i) : -1;
+        if (!isValue(type, values[i])) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // every object is of a type there can be objects of, and holds as
+    // many values as it has elements or attributes. the registers of
+    // the module, when there are any, are all there.
+    bool isHeap() {
+      auto typeRecords = section<GCacheType>(header->types);
+      auto objectRecords = section<GCacheObject>(header->objects);
+      for (uint32_t i = 0; i < header->objects.count; i++) {
+        auto& record = objectRecords[i];
+        if (!isIndex(record.type, header->types.count) ||
+            !isSpan(record.values, header->values)) {
+          return false;
+        }
+        auto& type = typeRecords[record.type];
+        auto known = getKnownType(record.type);
+        bool isValid = false;
+        if (known == getStringType()) {
+          isValid = record.size >= 0 && record.data <= header->strings.count &&
+            (uint32_t) record.size <= header->strings.count - record.data &&
+            record.values.count == 0;
+        } else if (known == getFunctionType()) {
+          isValid = isIndex(record.data, header->functions.count) &&
+            record.values.count == 0;
+        } else if (type.kind == ARRAY_TYPE) {
+          auto values = section<uint64_t>(header->values) + record.values.offset;
+          isValid = record.values.count <= INT32_MAX;
+          for (uint32_t j = 0; isValid && j < record.values.count; j++) {
+            isValid = isValue(intAt(type.subTypes, 0), values[j]);
+          }
+        } else if (type.kind == TUPLE_TYPE) {
+          isValid = record.values.count == type.subTypes.count &&
+            areValues(record.values, type.subTypes, type.subTypes.count);
+        } else if (type.kind == CLASS_TYPE) {
+          auto& cls = section<GCacheClass>(header->classes)[type.index];
+          auto& environment = section<GCacheEnvironment>(header->environments)[cls.environment];
+          isValid = record.values.count == (uint32_t) cls.attributeCount &&
+            areValues(record.values, environment.localsTypes, cls.attributeCount);
+        }
+        if (!isValid) {
+          return false;
+        }
+      }
+
+      auto& module = section<GCacheEnvironment>(header->environments)[0];
+      return isSpan(header->registers, header->values) &&
+        (header->registers.count == 0 ||
+         header->registers.count == (uint32_t) module.localsCount) &&
+        areValues(header->registers, module.localsTypes,
+                  std::min<int64_t>(module.localsCount, module.localsTypes.count));
+    }
+
+    template <class T>
+    T* section(GCacheSpan& span) {
+      return (T*) (base + span.offset);
+    }
+
+    int32_t intAt(GCacheSpan& span, int i) {
+      return section<int32_t>(header->ints)[span.offset + i];
+    }
+
+    const char* string(uint32_t offset) {
+      return section<char>(header->strings) + offset;
+    }
+
+    GType* getType(int32_t index) {
+      return index < 0 ? NULL : types[index];
+    }
+
+    static bool isIndex(int64_t index, int64_t count) {
+      return index >= 0 && index < count;
+    }
+
+    // -1 stands for none.
+    static bool isOptionalIndex(int64_t index, int64_t count) {
+      return index >= -1 && index < count;
+    }
+
+    static bool isSpan(GCacheSpan& span, GCacheSpan& section) {
+      return (uint64_t) span.offset + span.count <= section.count;
+    }
+
+    bool isString(int64_t offset) {
+      return isIndex(offset, header->strings.count) &&
+        memchr(string(offset), '\0', header->strings.count - offset) != NULL;
+    }
+
+    bool areIndices(GCacheSpan& span, int64_t count) {
+      if (!isSpan(span, header->ints)) {
+        return false;
+      }
+      for (uint32_t i = 0; i < span.count; i++) {
+        if (!isIndex(intAt(span, i), count)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool areTypes(GCacheSpan& span) {
+      if (!isSpan(span, header->ints)) {
+        return false;
+      }
+      for (uint32_t i = 0; i < span.count; i++) {
+        if (!isOptionalIndex(intAt(span, i), header->types.count)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool areNames(GCacheSpan& span, int64_t count) {
+      if (!isSpan(span, header->names)) {
+        return false;
+      }
+      auto names = section<GCacheName>(header->names) + span.offset;
+      for (uint32_t i = 0; i < span.count; i++) {
+        if (!isString(names[i].name) || !isIndex(names[i].value, count)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool isConstant(GCacheConstant& constant) {
+      switch (constant.kind) {
+      case UNUSED_CONSTANT:
+      case FLOAT_CONSTANT:
+        return true;
+      case STRING_CONSTANT:
+        return (uint64_t) constant.first + constant.second <= header->strings.count;
+      case CSTRING_CONSTANT:
+        return isString(constant.first);
+      case TYPE_CONSTANT:
+        return isIndex(constant.first, header->types.count);
+      case FUNCTION_CONSTANT:
+        return isIndex(constant.first, header->functions.count);
+      case PRIMITIVE_METHOD_CONSTANT: {
+        if (!isString(constant.first) || !isString(constant.second)) {
+          return false;
+        }
+        auto type = primitives.find(string(constant.first));
+        return type != primitives.end() &&
+          type->second.find(string(constant.second)) != type->second.end();
+      }
+      default:
+        return false;
+      }
+    }
+
+    static bool isRegister(GOPARG operand, int32_t registerCount) {
+      return isIndex(operand.registerNum, registerCount);
+    }
+
+    // how many attributes the instance in a register has, if it holds
+    // one. registers are only shared by values of the same type.
+    int64_t getAttributeCount(GCacheEnvironment& environment, GOPARG operand) {
+      if (!isIndex(operand.registerNum, environment.localsTypes.count)) {
+        return 0;
+      }
+      auto type = intAt(environment.localsTypes, operand.registerNum);
+      if (type < 0) {
+        return 0;
+      }
+      auto& record = section<GCacheType>(header->types)[type];
+      if (record.kind != CLASS_TYPE) {
+        return 0;
+      }
+      return section<GCacheClass>(header->classes)[record.index].attributeCount;
+    }
+
+    // whether a direct call passes no more arguments than the function
+    // it calls has registers, and that function has code.
+    bool isCall(GCacheConstant& function, int32_t argumentCount) {
+      auto& callee = section<GCacheFunction>(header->functions)[function.first];
+      return callee.body >= 0 && argumentCount <=
+        section<GCacheEnvironment>(header->environments)[callee.environment].localsCount;
+    }
+
+    // the code of a body that's never run (one no function has) isn't
+    // checked past its constants, as it's never linked either.
+    bool isBody(GCacheBody& record, int32_t environmentIndex) {
+      if (!isSpan(record.code, header->code) ||
+          !isSpan(record.constants, header->constants) ||
+          record.code.count > INT32_MAX || record.constants.count > INT32_MAX) {
+        return false;
+      }
+      auto constants = section<GCacheConstant>(header->constants) + record.constants.offset;
+      for (uint32_t i = 0; i < record.constants.count; i++) {
+        if (!isConstant(constants[i])) {
+          return false;
+        }
+      }
+
+      if (environmentIndex < 0) {
+        return true;
+      }
+      auto& environment = section<GCacheEnvironment>(header->environments)[environmentIndex];
+      auto registerCount = environment.localsCount;
+      auto code = section<GOPARG>(header->code) + record.code.offset;
+      int64_t size = record.code.count;
+      std::vector<bool> isStart(size, false);
+      std::vector<int64_t> targets;
+      GOPCODE op = END;
+      for (int64_t pc = 0; pc < size; ) {
+        // the free bits are only ever set once the code is linked.
+        if (!isIndex(code[pc].op, GOPCODE_COUNT)) {
+          return false;
+        }
+        isStart[pc] = true;
+        op = (GOPCODE) code[pc].op;
+        auto kinds = getOpInfo(op).operands;
+        int64_t fixedCount = strlen(kinds);
+        if (pc + 1 + fixedCount > size) {
+          return false;
+        }
+        auto operands = code + pc + 1;
+        for (int64_t i = 0; i < fixedCount; i++) {
+          switch (kinds[i]) {
+          case 'w':
+          case 'r':
+          case 'x':
+            if (!isRegister(operands[i], registerCount)) {
+              return false;
+            }
+            break;
+          case 'k':
+            // and the constant is of the kind the instruction reads.
+            if (!isIndex(operands[i].constantIndex, record.constants.count) ||
+                constants[operands[i].constantIndex].kind != getConstantKind(op)) {
+              return false;
+            }
+            break;
+          case 'j':
+            targets.push_back(pc + operands[i].positionDiff);
+            break;
+          case 'n':
+            if (operands[i].size < 0 || pc + 1 + fixedCount + operands[i].size > size) {
+              return false;
+            }
+            for (int32_t j = 0; j < operands[i].size; j++) {
+              if (!isRegister(operands[fixedCount + j], registerCount)) {
+                return false;
+              }
+            }
+            break;
+          }
+        }
+        // immediates that index the tables of the environment, or the
+        // attributes of an instance.
+        bool isValidInstruction = true;
+        switch (op) {
+        case FUNCTION_CREATE:
+          isValidInstruction = isIndex(operands[1].registerNum, environment.functions.count);
+          break;
+        case GLOBAL_LOAD:
+          isValidInstruction = isIndex(operands[1].registerNum, environment.globalsCount);
+          break;
+        case GLOBAL_SET:
+          isValidInstruction = isIndex(operands[0].registerNum, environment.globalsCount);
+          break;
+        case TYPE_LOAD:
+          isValidInstruction = isIndex(operands[1].registerNum, environment.classes.count);
+          break;
+        case INSTANCE_LOAD_ATTRIBUTE:
+          isValidInstruction = isIndex(operands[2].registerNum,
+                                       getAttributeCount(environment, operands[1]));
+          break;
+        case INSTANCE_SET_ATTRIBUTE:
+          isValidInstruction = isIndex(operands[1].registerNum,
+                                       getAttributeCount(environment, operands[0]));
+          break;
+        case CALL_DIRECT:
+          isValidInstruction = isCall(constants[operands[1].constantIndex],
+                                      operands[2].size);
+          break;
+        case CALL_METHOD_DIRECT:
+          isValidInstruction = isCall(constants[operands[2].constantIndex],
+                                      operands[3].size + 1);
+          break;
+        default:
+          break;
+        }
+        if (!isValidInstruction) {
+          return false;
+        }
+        pc += getInstructionSize(op, operands);
+      }
+      // jumps land on an instruction, and nothing runs past the END.
+      for (auto target : targets) {
+        if (!isIndex(target, size) || !isStart[target]) {
+          return false;
+        }
+      }
+      return size > 0 && op == END;
+    }
+
+    GBytecode* loadBody(GCacheBody& record) {
+      auto constantRecords = section<GCacheConstant>(header->constants) +
+        record.constants.offset;
+      auto constants = new GValue[record.constants.count]();
+      for (uint32_t i = 0; i < record.constants.count; i++) {
+        auto& constant = constantRecords[i];
+        switch (constant.kind) {
+        case UNUSED_CONSTANT:
+          break;
+        case FLOAT_CONSTANT: {
+          uint64_t bits = ((uint64_t) constant.second << 32) | constant.first;
+          memcpy(&constants[i].asFloat, &bits, sizeof(bits));
+          break;
+        }
+        case STRING_CONSTANT:
+          constants[i].asString = internString(std::string(string(constant.first),
+                                                           constant.second));
+          break;
+        case CSTRING_CONSTANT:
+          constants[i].asCString = string(constant.first);
+          break;
+        case TYPE_CONSTANT:
+          constants[i].asType = getType(constant.first);
+          break;
+        case FUNCTION_CONSTANT:
+          constants[i].asRawFunction = functions[constant.first];
+          break;
+        case PRIMITIVE_METHOD_CONSTANT:
+          constants[i].asPrimitiveMethod =
+            primitives[string(constant.first)][string(constant.second)].rawMethod;
+          break;
+        }
+      }
+      return new GBytecode {
+        .code = section<GOPARG>(header->code) + record.code.offset,
+        .size = (int) record.code.count,
+        .constants = constants,
+        .constantsCount = (int) record.constants.count,
+        .linked = false
+      };
+    }
+
+    void loadNames(GCacheSpan& span, GSymbolTable& table) {
+      auto names = section<GCacheName>(header->names) + span.offset;
+      for (uint32_t i = 0; i < span.count; i++) {
+        table[gstd::intern(string(names[i].name))] = names[i].value;
+      }
+    }
+
+    void loadEnvironment(GCacheEnvironment& record, GEnvironment* environment) {
+      if (record.parent >= 0) {
+        environment->parent = environments[record.parent];
+      }
+      environment->isModule = record.isModule;
+      environment->localsCount = record.localsCount;
+      for (uint32_t i = 0; i < record.localsTypes.count; i++) {
+        environment->localsTypes.push_back(getType(intAt(record.localsTypes, i)));
+        environment->localsTemporary.push_back(false);
+      }
+      environment->globalsCount = record.globalsCount;
+      for (uint32_t i = 0; i < record.globalsTypes.count; i++) {
+        environment->globalsTypes.push_back(getType(intAt(record.globalsTypes, i)));
+        environment->indicesInParent.push_back(intAt(record.indicesInParent, i));
+      }
+      for (uint32_t i = 0; i < record.functions.count; i++) {
+        environment->functions.push_back(functions[intAt(record.functions, i)]);
+      }
+      environment->functionsCount = environment->functions.size();
+      for (uint32_t i = 0; i < record.classes.count; i++) {
+        environment->classes.push_back(getType(intAt(record.classes, i)));
+      }
+      environment->classesCount = environment->classes.size();
+      loadNames(record.localsByName, environment->localsByName);
+      loadNames(record.globalsByName, environment->globalsByName);
+      loadNames(record.functionsByName, environment->functionsByName);
+      loadNames(record.classesByName, environment->classesByName);
+    }
+  };
+
+  static bool isValid(GCacheHeader* header, size_t size, const GModuleCacheKey& key) {
+    if (memcmp(header->magic, "GHC", 4) != 0 ||
+        header->format != MODULE_CACHE_FORMAT ||
+        header->key.sourceHash != key.sourceHash ||
+        header->key.compilerHash != key.compilerHash ||
+        header->key.optimizationLevel != key.optimizationLevel ||
+        header->checksum != hashBytes((const char*) (header + 1), size - sizeof(*header))) {
+      return false;
+    }
+    GCacheSpan* sections[] = {
+      &header->types, &header->classes, &header->environments,
+      &header->functions, &header->bodies, &header->constants,
+      &header->names, &header->ints, &header->code, &header->strings,
+      &header->objects, &header->values
+    };
+    size_t recordSizes[] = {
+      sizeof(GCacheType), sizeof(GCacheClass), sizeof(GCacheEnvironment),
+      sizeof(GCacheFunction), sizeof(GCacheBody), sizeof(GCacheConstant),
+      sizeof(GCacheName), sizeof(int32_t), sizeof(GOPARG), sizeof(char),
+      sizeof(GCacheObject), sizeof(uint64_t)
+    };
+    for (int i = 0; i < 12; i++) {
+      if (sections[i]->offset > size ||
+          sections[i]->count > (size - sections[i]->offset) / recordSizes[i]) {
+        return false;
+      }
+    }
+    return header->environments.count > 0 && header->body >= 0 &&
+      (uint32_t) header->body < header->bodies.count;
+  }
+
+  // maps the cache at path, if it's one for key. it lives as long as
+  // the code in it does, which is as long as the process.
+  static GCacheHeader* mapCache(const std::string& path, const GModuleCacheKey& key,
+                                size_t& size) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(GCacheHeader)) {
+      close(fd);
+      return NULL;
+    }
+    // the code is linked in place by the execution engine, so the
+    // mapping is writable, but private to this process.
+    size = info.st_size;
+    auto mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+      return NULL;
+    }
+
+    auto header = (GCacheHeader*) mapping;
+    if (!isValid(header, size, key)) {
+      munmap(mapping, size);
+      return NULL;
+    }
+    return header;
+  }
+
+  GBytecode* loadModuleCache(const std::string& path, const GModuleCacheKey& key,
+                             GEnvironment* environment) {
+    size_t size;
+    auto header = mapCache(path, key, size);
+    if (header == NULL) {
+      return NULL;
+    }
+    GModuleCacheReader reader((const char*) header, header);
+    // only snapshots have a heap.
+    if (header->registers.count > 0 || !reader.check(environment)) {
+      debug("not loading corrupt module cache " << path);
+      munmap(header, size);
+      return NULL;
+    }
+    return reader.load(environment);
+  }
+
+  bool loadSnapshot(const std::string& path, GEnvironmentInstance& root) {
+    size_t size;
+    auto header = mapCache(path, getSnapshotKey(), size);
+    if (header == NULL) {
+      return false;
+    }
+    auto environment = root.environment;
+    GModuleCacheReader reader((const char*) header, header);
+    if (!reader.check(environment)) {
+      debug("not loading corrupt snapshot " << path);
+      munmap(header, size);
+      return false;
+    }
+    reader.load(environment);
+
+    // the root frame sits at the bottom of the register stack.
+    root.globals = environment->resolveGlobals(getBaseEnvironmentInstance());
+    root.locals = getRegisterStack()->push(environment->localsCount);
+    reader.loadHeap(root);
+    // what running the declarations did: classes are loaded, and
+    // functions of the module resolved against it.
+    for (auto cls : environment->classes) {
+      cls->load(root);
+    }
+    for (auto function : environment->functions) {
+      if (function->isStatic && function->globals == NULL) {
+        function->globals = function->environment->resolveGlobals(root);
+      }
+    }
+    return true;
+  }
+}
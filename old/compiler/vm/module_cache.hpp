@@ -0,0 +1,74 @@
+#include <stdint.h>
+#include <string>
+#include "bytecode.hpp"
+#include "environment.hpp"
+
+#ifndef VM_MODULE_CACHE_HPP
+#define VM_MODULE_CACHE_HPP
+
+namespace VM {
+
+  /*
+    a compiled module, saved next to its source (foo.gh -> foo.ghc) so
+    it can be run again without tokenizing, parsing or generating it.
+
+    the file is a header followed by tables of fixed size records:
+    types, classes, environments, functions and bodies, plus the
+    constants, names and index lists they refer to, the bytecode, and
+    a pool of strings. records refer to each other by their index in
+    a table, and to everything else by their offset from the start of
+    the file, so nothing in it has to be relocated when it's loaded.
+
+    the file is mapped rather than read. the code of every body runs
+    straight out of the mapping (privately, so the execution engine
+    can still link it in place), while the objects the records
+    describe, and the constant pools, are rebuilt from them.
+
+    a cache is only used for the source, compiler and optimization
+    level it was written for. the compiler is known by the build id of
+    its binary (or its contents, without one), so any change to it
+    leaves the caches of the last build behind. MODULE_CACHE_FORMAT is
+    bumped whenever the layout of the file changes.
+
+    a snapshot is the same file, for a root environment whose code has
+    already run: along with the records, it holds the values of its
+    registers and every object they reach, which are rebuilt when it's
+    loaded instead of running that code again.
+   */
+  const uint32_t MODULE_CACHE_FORMAT = 4;
+
+  typedef struct GModuleCacheKey {
+    uint64_t sourceHash;
+    uint64_t compilerHash;
+    int32_t optimizationLevel;
+  } GModuleCacheKey;
+
+  GModuleCacheKey getModuleCacheKey(const char* source, size_t size,
+                                    int optimizationLevel);
+  std::string getModuleCachePath(const std::string& sourcePath);
+
+  // saves the module compiled into environment, with body as the code
+  // at its top level. returns false if the cache couldn't be written.
+  bool writeModuleCache(const std::string& path, const GModuleCacheKey& key,
+                        GEnvironment* environment, GBytecode* body);
+
+  // loads a module saved with writeModuleCache into environment, which
+  // has to be as fresh as the one it was compiled into, and returns the
+  // code at its top level. NULL if there's no cache for key.
+  GBytecode* loadModuleCache(const std::string& path, const GModuleCacheKey& key,
+                             GEnvironment* environment);
+
+  // saves root, an instance of a module whose code has run, as a
+  // snapshot. throws a VMException if it holds something that can't be
+  // saved, like a file or a function created in a call. returns false
+  // if the snapshot couldn't be written.
+  bool writeSnapshot(const std::string& path, GEnvironmentInstance& root);
+
+  // loads a snapshot into root, whose environment has to be fresh, and
+  // whose parent is the base environment. its registers are pushed on
+  // the register stack. false if there's no snapshot at path for this
+  // compiler.
+  bool loadSnapshot(const std::string& path, GEnvironmentInstance& root);
+}
+
+#endif
@@ -2,8 +2,8 @@
 
 namespace VM {
 
-  GValue* getNoneObject() {
-    auto noneObject = new GValue{ 0 };
-    return noneObject;
+  gstd::Arena& getCompilationArena() {
+    auto static arena = new gstd::Arena();
+    return *arena;
   }
 }
@@ -1,4 +1,5 @@
 #include "type.hpp"
+#include "../std/arena.hpp"
 #include <functional>
 #include <map>
 
@@ -9,10 +10,13 @@ namespace VM {
 
   union GValue;
   struct GArray;
+  struct GString;
   struct GObject;
   struct GEnvironmentInstance;
   struct GFunctionInstance;
-  typedef GValue* Builtin(GValue*);
+  // a native function: it's passed its arguments, and writes its
+  // return value (if it has one) to result.
+  typedef void Builtin(GValue* arguments, int argumentCount, GValue* result);
 
   typedef GValue  RawPrimitiveMethod(GValue, GValue*);
 
@@ -31,12 +35,18 @@ namespace VM {
     void* asNone;
     GArray* asArray;
     GArray* asTuple;
+    GString* asString;
     GEnvironmentInstance* asModule;
-    GEnvironmentInstance* asInstance;
+    // the attributes of an instance, right after its object header.
+    GValue* asInstance;
     GFunctionInstance* asFunction;
     Builtin* asBuiltin;
     GType* asType;
     FILE* asFile;
+    // only found in constant pools.
+    const char* asCString;
+    RawPrimitiveMethod* asPrimitiveMethod;
+    GFunction* asRawFunction;
   } GValue;
 
   typedef struct GArray {
@@ -44,6 +54,15 @@ namespace VM {
     int size;
   } GArray;
 
+  // strings are stored as bytes, rather than as an array of chars.
+  typedef struct GString {
+    char* bytes;
+    int size;
+    // literals are interned, and shared by every use of them. they're
+    // copied before they're changed.
+    bool isConstant;
+  } GString;
+
   typedef struct GObject {
     GType* type;
     GValue value;
@@ -57,14 +76,22 @@ namespace VM {
 
   struct GIndex;
 
+  // everything that only exists while code is compiled: the ast, the
+  // indices codegen passes around and its scopes. it's reset once
+  // the bytecode is generated.
+  gstd::Arena& getCompilationArena();
+
   typedef struct GIndex {
     GIndexType indexType;
     GIndex* objectIndex;
     int registerNum;
     GType* type;
-  } GIndex;
 
-  GValue* getNoneObject();
+    static void* operator new(size_t size) {
+      return getCompilationArena().allocate(size);
+    }
+    static void operator delete(void*) {}
+  } GIndex;
 
   std::string getValueDebugInfo(GValue v);
 }
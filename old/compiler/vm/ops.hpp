@@ -10,13 +10,18 @@ namespace VM {
   enum GOPCODE {
     ADD_INT,
     ADD_FLOAT,
+    ADD_INT_IMM,
     ARRAY_ALLOCATE,
     ARRAY_SET_VALUE,
     ARRAY_LOAD_VALUE,
     ARRAY_LOAD_LENGTH,
     BOOL_PRINT,
     BRANCH,
+    BRANCH_IF_EQ_INT,
+    BRANCH_IF_LT_INT,
     BUILTIN_CALL,
+    CALL_DIRECT,
+    CALL_METHOD_DIRECT,
     CHAR_EQ,
     DIVIDE_FLOAT,
     DIVIDE_INT,
@@ -28,12 +33,14 @@ namespace VM {
     GO,
     GLOBAL_LOAD,
     GLOBAL_SET,
+    INC_INT,
     INSTANCE_CREATE,
     INSTANCE_LOAD_ATTRIBUTE,
     INSTANCE_SET_ATTRIBUTE,
     INT_TO_FLOAT,
     INT_EQ,
     INT_OR,
+    LOAD_CONST_ADD,
     LOAD_CONSTANT_BOOL,
     LOAD_CONSTANT_CHAR,
     LOAD_CONSTANT_FLOAT,
@@ -49,23 +56,31 @@ namespace VM {
     PRINT_INT,
     PRINT_STRING,
     SET,
+    STRING_ALLOCATE,
+    STRING_COPY,
+    STRING_LOAD_CHAR,
+    STRING_LOAD_LENGTH,
+    STRING_SET_CHAR,
     SUBTRACT_FLOAT,
     SUBTRACT_INT,
     TYPE_LOAD,
     RETURN,
     RETURN_NONE,
+    // not an instruction: the number of opcodes above.
+    GOPCODE_COUNT,
   };
 
+  // a single word of bytecode: either an opcode, or one of its
+  // operands. anything larger than a word goes in the constant pool.
   typedef union {
+    int op;
     int registerNum;
     int positionDiff;
     int size;
+    int constantIndex;
     int asInt32;
     char asChar;
     bool asBool;
-    double asFloat;
-    FILE* asFile;
-    const char* asString;
   } GOPARG;
 
   typedef struct {
@@ -17,7 +17,9 @@ namespace VM {
       getBaseEnvironment().createInstance(*new GEnvironmentInstance{});
     auto static _initialized = false;
     if (!_initialized) {
-      envInst->locals[0].asModule = getBuiltins();
+      // builtins are loaded from the registers of the module, the same
+      // way attributes are loaded from an instance.
+      envInst->locals[0].asInstance = getBuiltins()->locals;
       _initialized = true;
     }
     return *envInst;
@@ -0,0 +1,49 @@
+#include "stack.hpp"
+#include "exception.hpp"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+namespace VM {
+
+  GValue* GRegisterStack::push(int size) {
+    auto frame = top;
+    if (size > limit - frame) {
+      throw VMException("stack overflow: the vm ran out of registers. "
+                        "use --stack-size to reserve more.");
+    }
+    memset(frame, 0, size * sizeof(GValue));
+    top += size;
+    return frame;
+  }
+
+  void GRegisterStack::pop(int size) {
+    top -= size;
+  }
+
+  static size_t registerStackSize = DEFAULT_REGISTER_STACK_SIZE;
+
+  void setRegisterStackSize(size_t size) {
+    registerStackSize = size;
+  }
+
+  GRegisterStack* getRegisterStack() {
+    auto static stack = new GRegisterStack();
+    auto static _initialized = false;
+    if (!_initialized) {
+      auto bytes = registerStackSize * sizeof(GValue);
+      auto memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      if (memory == MAP_FAILED) {
+        fprintf(stderr, "unable to reserve the register stack\n");
+        exit(1);
+      }
+      stack->base = (GValue*) memory;
+      stack->top = stack->base;
+      stack->limit = stack->base + registerStackSize;
+      _initialized = true;
+    }
+    return stack;
+  }
+}
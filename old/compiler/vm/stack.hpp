@@ -0,0 +1,59 @@
+#include "bytecode.hpp"
+#include "environment.hpp"
+#include "object.hpp"
+
+#ifndef VM_STACK_HPP
+#define VM_STACK_HPP
+
+namespace VM {
+
+  /*
+    the registers of every active call live on a single stack.
+
+    the whole stack is reserved as one block of address space up
+    front, and the os only commits the pages that are actually
+    touched. this means it can grow without ever moving: frames (and
+    the pointers into them held by globals tables) stay valid for as
+    long as the frame is alive.
+
+    frames are allocated by bumping top, and must be released in the
+    reverse order they were allocated.
+   */
+  typedef struct GRegisterStack {
+    GValue* base;
+    GValue* top;
+    GValue* limit;
+
+    // returns a frame of size registers, all zeroed.
+    GValue* push(int size);
+    void    pop(int size);
+  } GRegisterStack;
+
+  // the number of registers reserved for the stack, unless
+  // setRegisterStackSize is called before the stack is first used.
+  const size_t DEFAULT_REGISTER_STACK_SIZE = 8 * 1024 * 1024;
+
+  void setRegisterStackSize(size_t size);
+  GRegisterStack* getRegisterStack();
+
+  /*
+    a call in progress. the frame is stored on the register stack,
+    right before the registers of the callee.
+   */
+  typedef struct GCallFrame {
+    // the call this one was made from, or NULL if it was made
+    // from the code the execution engine was invoked with.
+    GCallFrame* previous;
+    // in registers, the frame included.
+    int size;
+    GBytecode* returnBytecode;
+    GOPARG* returnPc;
+    int returnRegister;
+    GEnvironmentInstance instance;
+  } GCallFrame;
+
+  // the number of registers taken by a GCallFrame.
+  const int CALL_FRAME_SIZE = (sizeof(GCallFrame) + sizeof(GValue) - 1) / sizeof(GValue);
+}
+
+#endif
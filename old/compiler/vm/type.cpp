@@ -1,6 +1,7 @@
 #include "type.hpp"
 #include "environment.hpp"
 #include "function.hpp"
+#include "gc.hpp"
 #include <sstream>
 #include <map>
 
@@ -100,18 +101,70 @@ namespace VM {
     return tupleTypes[name];
   }
 
-  GEnvironmentInstance* GType::instantiate() {
-    auto instance = environment->createInstance(*parentEnv);
-    // we instantiate all the methods, binding them to the current context.
+  // every instance of a class is the same size, so they all come
+  // from a pool of their own, which copies bound to frames share.
+  static GObjectPool* createPool(GType* type) {
+    return new GObjectPool {
+      .objectSize = (int) (sizeof(GObjectHeader) + type->attributeCount * sizeof(GValue))
+    };
+  }
+
+  GValue* GType::instantiate() {
+    if (pool == NULL) {
+      pool = createPool(this);
+    }
+    return (GValue*) poolAllocate(pool, this);
+  }
+
+  // methods are shared by every instance. a class declared in a module
+  // is loaded against the module's single instance, so the globals of
+  // its methods are resolved in place. one declared in a function gets
+  // a copy bound to each frame it's loaded in instead, reused when a
+  // frame with the same registers loads it again.
+  GType* GType::load(GEnvironmentInstance& parent) {
+    if (methods == NULL) {
+      methods = new GFunction*[functionCount];
+      int firstMethod = environment->functions.size() - functionCount;
+      for (int i = 0; i < functionCount; i++) {
+        methods[i] = environment->functions[firstMethod + i];
+        methods[i]->methodIndex = i;
+        methods[i]->globals = new GValue*[methods[i]->environment->globalsCount];
+      }
+    }
+
+    if (parent.environment->isModule) {
+      if (parentEnv != &parent) {
+        parentEnv = &parent;
+        for (int i = 0; i < functionCount; i++) {
+          methods[i]->environment->resolveGlobals(parent, methods[i]->globals);
+        }
+      }
+      return this;
+    }
+
+    auto key = std::make_pair(parent.locals, parent.globals);
+    auto binding = bindings.find(key);
+    if (binding != bindings.end()) {
+      return binding->second;
+    }
+    if (pool == NULL) {
+      pool = createPool(this);
+    }
+    auto type = new GType {
+      .name = name,
+      .subTypes = subTypes,
+      .attributeCount = attributeCount,
+      .functionCount = functionCount,
+      .methods = methods,
+      .methodGlobals = new GValue**[functionCount],
+      .environment = environment,
+      .pool = pool
+    };
     for (int i = 0; i < functionCount; i++) {
-      // methods are instantiate after type.
-      int methodIndex = i + attributeCount;
-      instance->locals[methodIndex].asFunction = new GFunctionInstance {
-        .function = environment->functions[i],
-        .parentEnv = *instance
-      };
+      type->methodGlobals[i] = methods[i]->environment->resolveGlobals(parent);
     }
-    return instance;
+    bindings[key] = type;
+    return type;
   }
 
   bool isTupleType(GType* type) {
@@ -1,4 +1,6 @@
+#include <map>
 #include <string>
+#include <utility>
 #include "../std/gstd.hpp"
 
 #ifndef VM2_TYPE_HPP
@@ -11,20 +13,24 @@ namespace VM {
   struct GEnvironmentInstance;
 
   struct GType;
+  struct GObjectPool;
+  union GValue;
 
   /*
     some notes about GType:
-    instances of types are just environment instances that expose only their locals.
-    they work by have each method instantiate with that instance as the scope.
+    an instance is a single object: its attributes, typed by the locals of
+    the environment, right after the object header (which holds the type).
+    methods aren't bound to an instance: they're called with the instance
+    as their first register, and read and write its attributes through it.
 
-    assumptions are made regarding the order of the registers of an environmental
-    scope. The order is:
+    the methods are the last functionCount functions of the environment, and
+    are shared by every instance through the method table of the type.
 
-    * attributes
-    * methods
-
-    this order is required, because an instantiate() will automatically populate
-    functions bound to the internal scope of the instance.
+    a class declared in a function is loaded by every call of it, and its
+    methods have to see the frame that loaded it. so each frame gets a
+    copy of the type bound to it, holding the globals of every method
+    resolved against that frame, and the instances created there point
+    at that copy.
    */
   typedef struct GType {
     std::string name;
@@ -34,12 +40,24 @@ namespace VM {
     gstd::Array<GType*> subTypes;
     int attributeCount;
     int functionCount;
+    // the methods of the class, built the first time it's loaded.
+    GFunction** methods;
+    // for a copy bound to a frame: the globals of each method.
+    GValue*** methodGlobals;
     // this is necessary to invoke methods
     GEnvironmentInstance* parentEnv;
     GEnvironment* environment;
     // this is actually what contains
     // the variables.
-    GEnvironmentInstance* instantiate();
+    // where instances are allocated from.
+    GObjectPool* pool;
+    // the copies bound to frames so far, by the locals and globals of
+    // the frame.
+    std::map<std::pair<GValue*, GValue**>, GType*> bindings;
+    GValue* instantiate();
+    // called every time the class declaration is run. returns the type
+    // to create instances of in parent.
+    GType* load(GEnvironmentInstance& parent);
     bool isPrimitive;
   } GType;
 
@@ -1,5 +1,6 @@
 #include <map>
 #include "array.hpp"
+#include "../gc.hpp"
 
 using gstd::Array;
 
@@ -21,6 +22,13 @@ namespace VM {
     return type->name.find("Array") != std::string::npos;
   }
 
+  GArray* allocateArray(GType* type, int size) {
+    auto array = (GArray*) gcAllocate(type, sizeof(GArray) + size * sizeof(GValue));
+    array->elements = (GValue*) (array + 1);
+    array->size = size;
+    return array;
+  }
+
   GValue arraySize(GValue array, GValue*) {
     return {array.asArray->size};
   }
@@ -8,6 +8,10 @@ namespace VM {
   GType* getArrayType(GType* elementType);
   bool isArrayType(GType*);
 
+  // an array (or tuple) of size elements, all zero, with its
+  // elements stored right after it.
+  GArray* allocateArray(GType* type, int size);
+
   extern PrimitiveMethodMap arrayMethods;
 }
 
@@ -1,10 +1,23 @@
 #include "primitives.hpp"
 #include "array.hpp"
+#include "string.hpp"
 
 
 namespace VM {
 
   PrimitiveMap primitives = {
-    {"Array", arrayMethods}
+    {"Array", arrayMethods},
+    {"String", getStringMethods()}
   };
+
+  std::string getPrimitiveMethodName(RawPrimitiveMethod* method) {
+    for (auto& type : primitives) {
+      for (auto& primitiveMethod : type.second) {
+        if (primitiveMethod.second.rawMethod == method) {
+          return type.first + "." + primitiveMethod.first;
+        }
+      }
+    }
+    return "unknown";
+  }
 }
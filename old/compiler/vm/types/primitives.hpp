@@ -6,4 +6,7 @@ namespace VM {
 
   typedef std::map<std::string, PrimitiveMethodMap> PrimitiveMap;
   extern PrimitiveMap primitives;
+
+  // "Type.method", for printing bytecode.
+  std::string getPrimitiveMethodName(RawPrimitiveMethod*);
 }
@@ -1,8 +1,74 @@
 #include "string.hpp"
+#include "../gc.hpp"
+#include <string.h>
+#include <map>
+
+using gstd::Array;
 
 namespace VM {
 
   GType* getStringType() {
-    return getArrayType(getCharType());
+    // strings are indexed and iterated over like an array of chars.
+    auto static stringType = new GType {
+      "String", Array<GType*>(new GType*[1] { getCharType() }, 1),
+      .isPrimitive = true
+    };
+    return stringType;
+  }
+
+  bool isStringType(GType* type) {
+    return type == getStringType();
+  }
+
+  // the bytes are stored along with the string, right after it.
+  static GString* initializeString(void* memory, int size) {
+    auto string = (GString*) memory;
+    string->bytes = (char*) (string + 1);
+    string->size = size;
+    return string;
+  }
+
+  GString* allocateString(int size) {
+    return initializeString(gcAllocate(getStringType(), sizeof(GString) + size), size);
+  }
+
+  GString* createString(const char* bytes, int size) {
+    auto string = allocateString(size);
+    memcpy(string->bytes, bytes, size);
+    return string;
+  }
+
+  GString* internString(const std::string& literal) {
+    static std::map<std::string, GString*> internedStrings;
+    auto interned = internedStrings.find(literal);
+    if (interned != internedStrings.end()) {
+      return interned->second;
+    }
+    // interned strings are never collected, so they're kept out of
+    // the heap.
+    auto string = initializeString(new char[sizeof(GString) + literal.size()](),
+                                   literal.size());
+    memcpy(string->bytes, literal.c_str(), literal.size());
+    string->isConstant = true;
+    internedStrings[literal] = string;
+    return string;
+  }
+
+  GString* getMutableString(GString* string) {
+    if (!string->isConstant) {
+      return string;
+    }
+    return createString(string->bytes, string->size);
+  }
+
+  GValue stringSize(GValue string, GValue*) {
+    return {string.asString->size};
+  }
+
+  PrimitiveMethodMap& getStringMethods() {
+    auto static stringMethods = new PrimitiveMethodMap {
+      {"size", { getInt32Type(), &stringSize}}
+    };
+    return *stringMethods;
   }
 }
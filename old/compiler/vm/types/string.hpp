@@ -1,4 +1,5 @@
 #include "../type.hpp"
+#include "../object.hpp"
 #include "array.hpp"
 
 #ifndef VM_TYPES_STRING_HPP
@@ -6,6 +7,20 @@
 
 namespace VM {
   GType* getStringType();
+  bool isStringType(GType*);
+
+  // a string of size bytes, all zero.
+  GString* allocateString(int size);
+  GString* createString(const char* bytes, int size);
+  // the constant string for a literal. the same literal always
+  // returns the same string.
+  GString* internString(const std::string& literal);
+  // string itself if it can be changed, and a copy of it if not.
+  GString* getMutableString(GString* string);
+
+  // a function rather than a global, so it can be used to initialize
+  // the primitives of other translation units.
+  PrimitiveMethodMap& getStringMethods();
 }
 
 #endif
@@ -10,20 +10,24 @@ using namespace VM;
   #define debug(s);
 #endif
 
-void VM::printInstructions(GInstruction* firstInstruction) {
-  auto done = false;
-  int instructionCount = 0;
-  while (!done) {
-    if (instructionCount < 10) {
+// instructions are prefixed by their offset in the bytecode, in
+// words. jumps are relative to it.
+void VM::printInstructions(GBytecode* bytecode) {
+  auto constants = bytecode->constants;
+  auto instruction = bytecode->code;
+  auto end = bytecode->code + bytecode->size;
+  while (instruction < end) {
+    int position = instruction - bytecode->code;
+    if (position < 10) {
       std::cout << "0";
     }
-    std::cout << instructionCount << ", ";
-    auto values = firstInstruction->args;
+    std::cout << position << ", ";
+    auto values = instruction + 1;
 
-    switch(firstInstruction->op) {
+    switch(getOpcode(*instruction)) {
 
     case ARRAY_ALLOCATE:
-      std::cout << "ARRAY_ALLOCATE: [" << values[1].size << "] -> {" << values[0].registerNum << "}";
+      std::cout << "ARRAY_ALLOCATE: [{" << values[1].registerNum << "}] " << constants[values[2].constantIndex].asType->name << " -> {" << values[0].registerNum << "}";
       break;
 
     case ARRAY_SET_VALUE:
@@ -42,6 +46,10 @@ void VM::printInstructions(GInstruction* firstInstruction) {
       std::cout << "ADD_INT: {" << values[0].registerNum << "} + {" << values[1].registerNum << "} -> {" << values[2].registerNum << "}";
       break;
 
+    case ADD_INT_IMM:
+      std::cout << "ADD_INT_IMM: {" << values[0].registerNum << "} + " << values[1].asInt32 << " -> {" << values[2].registerNum << "}";
+      break;
+
     case ADD_FLOAT:
       std::cout << "ADD_FLOAT";
       break;
@@ -50,6 +58,14 @@ void VM::printInstructions(GInstruction* firstInstruction) {
       std::cout << "BRANCH: {" << values[0].registerNum << "} ? " << values[1].positionDiff << " : " << values[2].positionDiff;
       break;
 
+    case BRANCH_IF_EQ_INT:
+      std::cout << "BRANCH_IF_EQ_INT: {" << values[0].registerNum << "} == {" << values[1].registerNum << "} ? " << values[2].positionDiff << " : " << values[3].positionDiff;
+      break;
+
+    case BRANCH_IF_LT_INT:
+      std::cout << "BRANCH_IF_LT_INT: {" << values[0].registerNum << "} < {" << values[1].registerNum << "} ? " << values[2].positionDiff << " : " << values[3].positionDiff;
+      break;
+
     case BOOL_PRINT:
       std::cout << "BOOL_PRINT: {" << values[0].registerNum << "}";
       break;
@@ -59,6 +75,17 @@ void VM::printInstructions(GInstruction* firstInstruction) {
                 << values[1].registerNum << "}()";
       break;
 
+    case CALL_DIRECT:
+      std::cout << "CALL_DIRECT: {" << values[0].registerNum << "} <- ("
+                << constants[values[1].constantIndex].asRawFunction << ")()";
+      break;
+
+    case CALL_METHOD_DIRECT:
+      std::cout << "CALL_METHOD_DIRECT: {" << values[0].registerNum << "} <- {"
+                << values[1].registerNum << "}.("
+                << constants[values[2].constantIndex].asRawFunction << ")()";
+      break;
+
     case CHAR_EQ:
       std::cout << "CHAR_EQ: {"
                 << values[0].registerNum << "} == {"
@@ -68,7 +95,6 @@ void VM::printInstructions(GInstruction* firstInstruction) {
 
     case END:
       std::cout << "END";
-      done = true;
       break;
 
     case FUNCTION_CREATE:
@@ -94,6 +120,10 @@ void VM::printInstructions(GInstruction* firstInstruction) {
                 << " <- {" << values[1].registerNum << "}";
       break;
 
+    case INC_INT:
+      std::cout << "INC_INT: {" << values[0].registerNum << "}++";
+      break;
+
     case INT_TO_FLOAT:
       std::cout << "INT_TO_FLOAT:";
       break;
@@ -124,6 +154,11 @@ void VM::printInstructions(GInstruction* firstInstruction) {
                 << values[2].registerNum << "}";
       break;
 
+    case LOAD_CONST_ADD:
+      std::cout << "LOAD_CONST_ADD: {" << values[0].registerNum << "} <- " << values[1].asInt32
+                << ", {" << values[2].registerNum << "} + {" << values[0].registerNum << "} -> {" << values[3].registerNum << "}";
+      break;
+
     case LOAD_CONSTANT_BOOL:
       std::cout << "LOAD_CONSTANT_BOOL: [" << values[0].registerNum << "] <- " << (values[1].asBool == true ? "true" : "false");
       break;
@@ -133,7 +168,7 @@ void VM::printInstructions(GInstruction* firstInstruction) {
       break;
 
     case LOAD_CONSTANT_FLOAT:
-      std::cout << "LOAD_CONSTANT_FLOAT: [" << values[0].registerNum << "] <- " << values[1].asFloat;
+      std::cout << "LOAD_CONSTANT_FLOAT: [" << values[0].registerNum << "] <- " << constants[values[1].constantIndex].asFloat;
       break;
 
     case LOAD_CONSTANT_INT:
@@ -141,7 +176,10 @@ void VM::printInstructions(GInstruction* firstInstruction) {
       break;
 
     case LOAD_CONSTANT_STRING:
-      std::cout << "LOAD_CONSTANT_STRING: {" << values[0].registerNum << "} <- \"" << values[1].asString << "\"";
+      std::cout << "LOAD_CONSTANT_STRING: {" << values[0].registerNum << "} <- \"";
+      std::cout.write(constants[values[1].constantIndex].asString->bytes,
+                      constants[values[1].constantIndex].asString->size);
+      std::cout << "\"";
       break;
 
     case LESS_THAN_INT:
@@ -152,10 +190,13 @@ void VM::printInstructions(GInstruction* firstInstruction) {
       std::cout << "MULTIPLY_FLOAT: {" << values[0].registerNum << "} * {" << values[1].registerNum << "} -> " << values[2].registerNum;
       break;
 
+    case MULTIPLY_INT:
+      std::cout << "MULTIPLY_INT: {" << values[0].registerNum << "} * {" << values[1].registerNum << "} -> {" << values[2].registerNum << "}";
+      break;
+
     case PRIMITIVE_METHOD_CALL:
-      std::cout << "PRIMITIVE_METHOD_CALL (" << values[2].asString << "): {"
-                << values[0].registerNum << "} <- {" << values[1].asString
-                << "}." << values[3].asString << "()";
+      std::cout << "PRIMITIVE_METHOD_CALL (" << getPrimitiveMethodName(constants[values[2].constantIndex].asPrimitiveMethod) << "): {"
+                << values[0].registerNum << "} <- {" << values[1].registerNum << "}";
       break;
 
     case PRINT_CHAR:
@@ -186,6 +227,26 @@ void VM::printInstructions(GInstruction* firstInstruction) {
       std::cout << "SET: {" << values[0].registerNum << "} -> {" << values[1].registerNum << "}";
       break;
 
+    case STRING_ALLOCATE:
+      std::cout << "STRING_ALLOCATE: [{" << values[1].registerNum << "}] -> {" << values[0].registerNum << "}";
+      break;
+
+    case STRING_LOAD_CHAR:
+      std::cout << "STRING_LOAD_CHAR: {" << values[2].registerNum << "} <- {"  << values[0].registerNum << "}[{" << values[1].registerNum << "}]";
+      break;
+
+    case STRING_LOAD_LENGTH:
+      std::cout << "STRING_LOAD_LENGTH: {" << values[0].registerNum << "}.length -> {"  << values[1].registerNum << "}";
+      break;
+
+    case STRING_COPY:
+      std::cout << "STRING_COPY: {" << values[0].registerNum << "} -> {" << values[1].registerNum << "}";
+      break;
+
+    case STRING_SET_CHAR:
+      std::cout << "STRING_SET_CHAR: {" << values[2].registerNum << "} -> {"  << values[0].registerNum << "}[{" << values[1].registerNum << "}]";
+      break;
+
     case SUBTRACT_INT:
       std::cout << "SUBTRACT_INT: {" << values[0].registerNum << "} - {" << values[1].registerNum << "} -> {" << values[2].registerNum << "}";
       break;
@@ -195,11 +256,10 @@ void VM::printInstructions(GInstruction* firstInstruction) {
       break;
 
     default:
-      std::cout << "unable to print opcode: " << firstInstruction->op;
+      std::cout << "unable to print opcode: " << getOpcode(*instruction);
       break;
     }
-    firstInstruction++;
-    instructionCount++;
+    instruction += getInstructionSize(instruction);
     std::cout << std::endl;
   }
 }
@@ -10,6 +10,7 @@
 
 #include "object.hpp"
 #include "ops.hpp"
+#include "bytecode.hpp"
 #include "environment.hpp"
 #include "type.hpp"
 #include "types/array.hpp"
@@ -28,7 +29,7 @@ namespace VM {
     GModules* modules;
   } GVM;
 
-  void printInstructions(GInstruction*);
+  void printInstructions(GBytecode*);
   void loadModules(std::string stdlibPath);
 };
 